@@ -0,0 +1,108 @@
+/*
+Copyright 2020 Jerson Leonardo Huerfano Romero
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <benchmark/benchmark.h>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+#include "umodbus.h"
+
+// Per-word cost of converting registers to and from wire order. The probe_*
+// functions reproduce the former runtime endianness check as the baseline.
+
+static __attribute__((noinline)) uint8_t probe_endianness() {
+    uint16_t i = 0x00FF;
+    uint8_t * ptr = (uint8_t*)&i;
+    return *ptr == 0x00 ? UMODBUS_BIG_ENDIAN : UMODBUS_LITTLE_ENDIAN;
+}
+
+static void probe_copy_to_wire(uint8_t * dst, const uint16_t * src, const size_t & count) {
+    for(size_t i = 0; i < count; i++) {
+        uint16_t val = src[i];
+        if(probe_endianness() == UMODBUS_LITTLE_ENDIAN) {
+            val = (val >> 8) + (val << 8);
+        }
+        memcpy(dst + i * 2, &val, 2);
+    }
+}
+
+static uint16_t probe_load(const uint8_t * src) {
+    uint16_t val;
+    if(probe_endianness() == UMODBUS_LITTLE_ENDIAN) {
+        val = src[0];
+        val = (val << 8) + src[1];
+    } else {
+        val = src[0];
+        val = val + (((uint16_t)src[1]) << 8);
+    }
+    return val;
+}
+
+static void BM_ToWireRuntimeProbe(benchmark::State & state) {
+    std::vector<uint16_t> src(state.range(0), 0x1234);
+    std::vector<uint8_t> dst(state.range(0) * 2);
+
+    for(auto _ : state) {
+        probe_copy_to_wire(dst.data(), src.data(), src.size());
+        benchmark::DoNotOptimize(dst.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ToWireRuntimeProbe)->Arg(1)->Arg(16)->Arg(125);
+
+static void BM_ToWireCompileTime(benchmark::State & state) {
+    std::vector<uint16_t> src(state.range(0), 0x1234);
+    std::vector<uint8_t> dst(state.range(0) * 2);
+
+    for(auto _ : state) {
+        umodbus::umodbus_copy_to_wire(dst.data(), src.data(), src.size());
+        benchmark::DoNotOptimize(dst.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ToWireCompileTime)->Arg(1)->Arg(16)->Arg(125);
+
+static void BM_LoadRuntimeProbe(benchmark::State & state) {
+    std::vector<uint8_t> src(state.range(0) * 2, 0x12);
+
+    for(auto _ : state) {
+        uint32_t sum = 0;
+        for(int64_t i = 0; i < state.range(0); i++) {
+            sum += probe_load(src.data() + i * 2);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_LoadRuntimeProbe)->Arg(125);
+
+static void BM_LoadCompileTime(benchmark::State & state) {
+    std::vector<uint8_t> src(state.range(0) * 2, 0x12);
+
+    for(auto _ : state) {
+        uint32_t sum = 0;
+        for(int64_t i = 0; i < state.range(0); i++) {
+            sum += umodbus::umodbus_load_u16(src.data() + i * 2);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_LoadCompileTime)->Arg(125);
+
+BENCHMARK_MAIN();
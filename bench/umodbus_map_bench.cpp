@@ -0,0 +1,82 @@
+/*
+Copyright 2020 Jerson Leonardo Huerfano Romero
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <benchmark/benchmark.h>
+#include <stdint.h>
+
+#include "umodbus.h"
+#include "umodbus_map.h"
+
+// Cost of one FC03 read on a sparse map, 16 points at every other address,
+// laid out at runtime (binary search) and by umodbus_map.h (direct index).
+
+class LookupServer : public umodbus::uModbus {
+public:
+    LookupServer(umodbus::register_t * buff, const size_t & len) : uModbus(1, buff, len) { }
+
+protected:
+    virtual bool prepare_response(umodbus::frame_t & request, umodbus::frame_t & response) {
+        return false;
+    }
+
+    virtual void send(const umodbus::frame_t & response) { }
+};
+
+static uint16_t p0, p1, p2, p3, p4, p5, p6, p7, p8, p9, p10, p11, p12, p13, p14, p15;
+
+typedef umodbus::umodbus_map<
+    UMODBUS_WORDS_ENTRY(0, UMODBUS_TYPE_HOLDING_REGISTER, p0), UMODBUS_WORDS_ENTRY(2, UMODBUS_TYPE_HOLDING_REGISTER, p1),
+    UMODBUS_WORDS_ENTRY(4, UMODBUS_TYPE_HOLDING_REGISTER, p2), UMODBUS_WORDS_ENTRY(6, UMODBUS_TYPE_HOLDING_REGISTER, p3),
+    UMODBUS_WORDS_ENTRY(8, UMODBUS_TYPE_HOLDING_REGISTER, p4), UMODBUS_WORDS_ENTRY(10, UMODBUS_TYPE_HOLDING_REGISTER, p5),
+    UMODBUS_WORDS_ENTRY(12, UMODBUS_TYPE_HOLDING_REGISTER, p6), UMODBUS_WORDS_ENTRY(14, UMODBUS_TYPE_HOLDING_REGISTER, p7),
+    UMODBUS_WORDS_ENTRY(16, UMODBUS_TYPE_HOLDING_REGISTER, p8), UMODBUS_WORDS_ENTRY(18, UMODBUS_TYPE_HOLDING_REGISTER, p9),
+    UMODBUS_WORDS_ENTRY(20, UMODBUS_TYPE_HOLDING_REGISTER, p10), UMODBUS_WORDS_ENTRY(22, UMODBUS_TYPE_HOLDING_REGISTER, p11),
+    UMODBUS_WORDS_ENTRY(24, UMODBUS_TYPE_HOLDING_REGISTER, p12), UMODBUS_WORDS_ENTRY(26, UMODBUS_TYPE_HOLDING_REGISTER, p13),
+    UMODBUS_WORDS_ENTRY(28, UMODBUS_TYPE_HOLDING_REGISTER, p14), UMODBUS_WORDS_ENTRY(30, UMODBUS_TYPE_HOLDING_REGISTER, p15)> sparse_map_t;
+
+static void run_reads(benchmark::State & state, LookupServer & server) {
+    uint8_t request[] = { UMODBUS_FNCODE_RD_M_HOLDING_REG, 0x00, 0x00, 0x00, 0x01 };
+    uint8_t response[UMODBUS_MAX_PDU_SIZE];
+    uint8_t address = 0;
+
+    for(auto _ : state) {
+        request[2] = address;
+        address = (address + 6) & 0x1F & ~1;
+        benchmark::DoNotOptimize(server.process(request, sizeof(request), response, sizeof(response)));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_SparseRuntimeMap(benchmark::State & state) {
+    umodbus::register_t registers[16];
+
+    for(size_t i = 0; i < 16; i++) {
+        registers[i] = sparse_map_t::map.reg[i];
+    }
+
+    LookupServer server(registers, 16);
+    run_reads(state, server);
+}
+BENCHMARK(BM_SparseRuntimeMap);
+
+static void BM_SparseCompiledMap(benchmark::State & state) {
+    LookupServer server(0, 0);
+
+    server.set_map(sparse_map_t::map);
+    run_reads(state, server);
+}
+BENCHMARK(BM_SparseCompiledMap);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,222 @@
+/*
+Copyright 2020 Jerson Leonardo Huerfano Romero
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <benchmark/benchmark.h>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+#include "umodbus.h"
+
+// Throughput of uModbus::poll() over replayed request streams. Every
+// iteration answers the whole stream, so time per iteration divided by
+// the stream length is the cost of one request including lookup, decode,
+// encode and the transport hand-over.
+
+#define BENCH_STREAM_LENGTH     256
+
+#define BENCH_DENSE             0
+#define BENCH_SPARSE            1
+#define BENCH_MIXED             2
+
+class ReplayServer : public umodbus::uModbus {
+public:
+    std::vector<std::vector<uint8_t> > requests;
+    uint8_t output[UMODBUS_MAX_PDU_SIZE];
+    size_t cursor;
+    size_t bytes;
+    size_t exceptions;
+
+    ReplayServer(umodbus::register_t * buff, const size_t & len) : uModbus(1, buff, len), cursor(0), bytes(0), exceptions(0) { }
+
+protected:
+    virtual bool prepare_response(umodbus::frame_t & request, umodbus::frame_t & response) {
+        if(this->cursor == this->requests.size()) {
+            this->cursor = 0;
+            return false;
+        }
+
+        request.ptr = this->requests[this->cursor].data();
+        request.size = this->requests[this->cursor].size();
+        response.ptr = this->output;
+        response.size = sizeof(this->output);
+        this->bytes += request.size;
+        this->cursor++;
+        return true;
+    }
+
+    virtual void send(const umodbus::frame_t & response) {
+        this->bytes += response.size;
+        this->exceptions += (response.size > 0 && (this->output[0] & 0x80) != 0) ? 1 : 0;
+        benchmark::DoNotOptimize(this->output);
+    }
+};
+
+// The backing storage and register_t entries of one map, points entries per table.
+//  dense:  single points at consecutive addresses, lookups are base + offset.
+//  sparse: single points at every other address, lookups binary search.
+//  mixed:  consecutive single words, 4 word blocks, 32 bit values and coil bit banks.
+class BenchMap {
+public:
+    std::vector<umodbus::register_t> registers;
+    std::vector<uint16_t> words;
+    std::vector<uint32_t> values;
+    std::vector<uint8_t> bits;
+    uint32_t coil_span;
+    uint32_t register_span;
+
+    BenchMap(const int & layout, const size_t & points) : words(points * 8), values(points), bits(points) {
+        uint16_t coil = 0;
+        uint16_t holding = 0;
+
+        for(size_t i = 0; i < points; i++) {
+            if(layout == BENCH_MIXED && i % 3 == 1) {
+                this->add(holding, UMODBUS_TYPE_HOLDING_REGISTER, &words[i * 8], 4);
+                this->add(coil, UMODBUS_TYPE_COIL_BITS, (uint16_t *)&bits[i], 8);
+                holding += 4;
+                coil += 8;
+            } else if(layout == BENCH_MIXED && i % 3 == 2) {
+                this->registers.push_back(umodbus::umodbus_bind_value(holding, UMODBUS_TYPE_HOLDING_REGISTER, values[i]));
+                this->add(coil, UMODBUS_TYPE_COIL, &words[i * 8 + 4], 1);
+                holding += 2;
+                coil += 1;
+            } else {
+                this->add(holding, UMODBUS_TYPE_HOLDING_REGISTER, &words[i * 8], 1);
+                this->add(coil, UMODBUS_TYPE_COIL, &words[i * 8 + 1], 1);
+                holding += (layout == BENCH_SPARSE) ? 2 : 1;
+                coil += (layout == BENCH_SPARSE) ? 2 : 1;
+            }
+        }
+
+        this->coil_span = coil;
+        this->register_span = holding;
+    }
+
+private:
+    void add(const uint16_t & address, const uint8_t & type, uint16_t * ptr, const uint16_t & count) {
+        umodbus::register_t reg = { address, type, ptr, count };
+        this->registers.push_back(reg);
+    }
+};
+
+static void put_u16(std::vector<uint8_t> & pdu, const uint16_t & value) {
+    pdu.push_back((uint8_t)(value >> 8));
+    pdu.push_back((uint8_t)(value & 0xFF));
+}
+
+static std::vector<uint8_t> make_request(const uint8_t & fnc, const uint16_t & address, const uint16_t & count) {
+    std::vector<uint8_t> pdu;
+
+    pdu.push_back(fnc);
+    put_u16(pdu, address);
+
+    switch (fnc)
+    {
+    case UMODBUS_FNCODE_WR_S_COIL:
+        put_u16(pdu, UMODBUS_COIL_ON);
+        break;
+    case UMODBUS_FNCODE_WR_S_HOLDING_REG:
+        put_u16(pdu, 0x1234);
+        break;
+    case UMODBUS_FNCODE_WR_M_COIL:
+        put_u16(pdu, count);
+        pdu.push_back((uint8_t)UMODBUS_TOPDIV(count, 8));
+        pdu.insert(pdu.end(), UMODBUS_TOPDIV(count, 8), 0xA5);
+        break;
+    case UMODBUS_FNCODE_WR_M_HOLDING_REGS:
+        put_u16(pdu, count);
+        pdu.push_back((uint8_t)(count * 2));
+        pdu.insert(pdu.end(), count * 2, 0x5A);
+        break;
+    default:
+        put_u16(pdu, count);
+        break;
+    }
+
+    return pdu;
+}
+
+static bool is_coil_function(const uint8_t & fnc) {
+    return fnc == UMODBUS_FNCODE_RD_M_COIL || fnc == UMODBUS_FNCODE_WR_S_COIL || fnc == UMODBUS_FNCODE_WR_M_COIL;
+}
+
+// args: function code, layout, points per table, quantity per request.
+static void BM_Poll(benchmark::State & state) {
+    uint8_t fnc = (uint8_t)state.range(0);
+    BenchMap map((int)state.range(1), (size_t)state.range(2));
+    uint16_t count = (uint16_t)state.range(3);
+    ReplayServer server(map.registers.data(), map.registers.size());
+    uint32_t span = is_coil_function(fnc) ? map.coil_span : map.register_span;
+    uint32_t seed = 12345;
+
+    // sparse maps only have gaps between points, so their requests address one point each.
+    for(size_t i = 0; i < BENCH_STREAM_LENGTH; i++) {
+        uint32_t step = (state.range(1) == BENCH_SPARSE) ? 2 : 1;
+        seed = seed * 1103515245 + 12345;
+        server.requests.push_back(make_request(fnc, (uint16_t)(((seed >> 8) % ((span - count) / step + 1)) * step), count));
+    }
+
+    // a stream answered with exceptions would measure the error path instead.
+    server.poll();
+
+    if(server.exceptions > 0) {
+        state.SkipWithError("requests answered with an exception");
+        return;
+    }
+
+    server.bytes = 0;
+
+    for(auto _ : state) {
+        server.poll();
+    }
+
+    state.SetItemsProcessed(state.iterations() * BENCH_STREAM_LENGTH);
+    state.SetBytesProcessed((int64_t)(server.bytes));
+    state.counters["per_request"] = benchmark::Counter((double)(state.iterations() * BENCH_STREAM_LENGTH), 
+        benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+}
+
+static void poll_arguments(benchmark::internal::Benchmark * b) {
+    const int functions[] = { 
+        UMODBUS_FNCODE_RD_M_COIL, UMODBUS_FNCODE_RD_M_HOLDING_REG, UMODBUS_FNCODE_WR_S_COIL,
+        UMODBUS_FNCODE_WR_S_HOLDING_REG, UMODBUS_FNCODE_WR_M_COIL, UMODBUS_FNCODE_WR_M_HOLDING_REGS 
+    };
+    const int points[] = { 10, 100, 1000, 10000 };
+
+    for(int fnc : functions) {
+        bool coils = is_coil_function((uint8_t)fnc);
+        bool single = fnc == UMODBUS_FNCODE_WR_S_COIL || fnc == UMODBUS_FNCODE_WR_S_HOLDING_REG;
+        int largest = coils ? ((fnc == UMODBUS_FNCODE_WR_M_COIL) ? 0x07B0 : 0x07D0) 
+            : ((fnc == UMODBUS_FNCODE_WR_M_HOLDING_REGS) ? 0x007B : 0x007D);
+        const int counts[] = { 1, coils ? 64 : 16, largest };
+
+        for(int layout = BENCH_DENSE; layout <= BENCH_MIXED; layout++) {
+            for(int n : points) {
+                for(int count : counts) {
+                    // the quantity has to fit in the table, sparse maps are read point by point.
+                    if((single || layout == BENCH_SPARSE) && count > 1) {
+                        continue;
+                    } else if(count > n) {
+                        continue;
+                    }
+                    b->Args({ fnc, layout, n, count });
+                }
+            }
+        }
+    }
+}
+BENCHMARK(BM_Poll)->ArgNames({ "fc", "layout", "points", "count" })->Apply(poll_arguments);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,42 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <umodbus.h>
+#include <umodbus_posix.h>
+
+// Linux simulator: serves 4096 holding and input registers on the given port (default 1502).
+
+#define POINTS 4096
+
+uint16_t holding[POINTS];
+uint16_t input[POINTS];
+
+umodbus::register_t registers[] = {
+    // { <address>,     <type>,     <ptr to array>,     <count> }
+    {  0, UMODBUS_TYPE_HOLDING_REGISTER,  holding,  POINTS },
+    {  0, UMODBUS_TYPE_INPUT_REGISTER,    input,    POINTS },
+};
+
+umodbus::uModbusPosixServer simulator(1, registers, 2);
+
+int main(int argc, char ** argv) {
+    uint16_t port = (argc > 1) ? (uint16_t)atoi(argv[1]) : 1502;
+    uint32_t tick = 0;
+
+    if(!simulator.listen(port)) {
+        perror("listen");
+        return 1;
+    }
+
+    printf("Serving %d registers on port %d\n", POINTS, port);
+
+    while(true) {
+        simulator.poll(10);
+
+        tick++;
+        for(size_t i = 0; i < POINTS; i++) {
+            input[i] = (uint16_t)(tick + i);
+        }
+    }
+
+    return 0;
+}
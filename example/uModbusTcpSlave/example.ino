@@ -3,6 +3,7 @@
 #include <Ethernet2.h>
 
 #define LED_PIN 13
+#define MODBUS_CLIENTS 4
 
 uint8_t mac[] = { 0xd2, 0x78, 0x54, 0x69, 0x16, 0x75 };
 
@@ -23,13 +24,15 @@ umodbus::register_t registers[] = {
     {  1, UMODBUS_TYPE_HOLDING_REGISTER,    UMODBUS_U16_PTROF(time) },
     // INPUT REGISTER: points to a uint16_t value. Can only read.
     {  2, UMODBUS_TYPE_INPUT_REGISTER,      UMODBUS_U16_PTROF(counter) },
-    // HOLDING REGISTER as float: As data in modbus should be encoded in big-endian format, 
-    // arduino must present the MSB first.
-    {  3, UMODBUS_TYPE_HOLDING_REGISTER,    UMODBUS_U16_NPTROF(factor, 1) },
-    {  4, UMODBUS_TYPE_HOLDING_REGISTER,    UMODBUS_U16_NPTROF(factor, 0) },
+    // HOLDING REGISTER as float: occupies addresses 3 and 4, most significant word first.
+    // Use umodbus::umodbus_bind_value<float, umodbus::umodbus_lsw_first> for masters expecting the low word first.
+    umodbus::umodbus_bind_value(3, UMODBUS_TYPE_HOLDING_REGISTER, factor),
 };
 EthernetServer server(502);
-umodbus::uModbusTcp temp_modbus_modbus(33, registers, 5);
+// one slot per concurrent master. every slot shares the register table above.
+EthernetClient clients[MODBUS_CLIENTS];
+umodbus::tcp_slot_t slots[MODBUS_CLIENTS];
+umodbus::uModbusTcpServer temp_modbus_modbus(33, registers, 5, slots, MODBUS_CLIENTS);
 
 void ethernet_loop();
 
@@ -78,18 +81,27 @@ void loop() {
 
 void ethernet_loop() {
     EthernetClient client = server.available();
-    bool client_connected = false;
+
     if(client) {
-        client_connected = true;
-        Serial.println("Connected. Once the connection is closed, loop will resume.");
-        while (client.connected()) {
-            temp_modbus_modbus.accept(&client);
-            temp_modbus_modbus.poll();
+        bool known = false;
+
+        for(uint8_t i = 0; i < MODBUS_CLIENTS && !known; i++) {
+            known = (clients[i] == client);
+        }
+
+        for(uint8_t i = 0; i < MODBUS_CLIENTS && !known; i++) {
+            if(!clients[i].connected()) {
+                temp_modbus_modbus.disconnect(&clients[i]);
+                clients[i] = client;
+                known = temp_modbus_modbus.accept(&clients[i]);
+                Serial.println("Connected.");
+            }
+        }
+
+        if(!known) {
+            client.stop();
         }
-    } 
-    delay(5);
-    client.stop();
-    if(client_connected) {
-        Serial.println("Disconnected.");
     }
+
+    temp_modbus_modbus.poll();
 }
\ No newline at end of file
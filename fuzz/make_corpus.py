@@ -0,0 +1,92 @@
+#!/usr/bin/env python3
+# Writes the seed corpora under fuzz/corpus/<harness>/, one file per input.
+# The seeds are the requests and responses the gtest suite exercises, moved
+# onto the register maps of the harnesses. Run it again after editing them.
+import os
+import struct
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+
+
+def pdu(fnc, fmt='', *values):
+    return struct.pack('>B' + fmt, fnc, *values)
+
+
+# uModbus::poll() records: response capacity, pdu length, pdu.
+def record(data, capacity=253):
+    return bytes([capacity, len(data)]) + data
+
+
+POLL = {
+    'read_coils': pdu(0x01, 'HH', 0, 9),
+    'read_coil_bits': pdu(0x01, 'HH', 1, 32),
+    'read_discrete_inputs': pdu(0x02, 'HH', 0, 17),
+    'read_holding': pdu(0x03, 'HH', 0, 16),
+    'read_holding_mixed': pdu(0x03, 'HH', 14, 15),
+    'read_holding_max': pdu(0x03, 'HH', 0, 125),
+    'read_holding_zero': pdu(0x03, 'HH', 0, 0),
+    'read_input': pdu(0x04, 'HH', 0, 32),
+    'read_input_overflow': pdu(0x04, 'HH', 0xFFFF, 0xFFFF),
+    'write_coil_on': pdu(0x05, 'HH', 4, 0xFF00),
+    'write_coil_off': pdu(0x05, 'HH', 0, 0x0000),
+    'write_coil_invalid': pdu(0x05, 'HH', 4, 0x2255),
+    'write_register': pdu(0x06, 'HH', 3, 0x1234),
+    'write_value_register': pdu(0x06, 'HH', 17, 0x5678),
+    'write_coils': pdu(0x0F, 'HHBBB', 0, 9, 2, 0xFF, 0x01),
+    'write_coil_bits': pdu(0x0F, 'HHBBB', 5, 10, 2, 0xFF, 0x02),
+    'write_coils_short': pdu(0x0F, 'HHB', 0, 0xFFFF, 0xFF),
+    'write_registers': pdu(0x10, 'HHBHHHH', 14, 4, 8, 1, 2, 3, 4),
+    'write_registers_short': pdu(0x10, 'HHBH', 0, 4, 8, 1),
+    'mask_write': pdu(0x16, 'HHH', 2, 0xF2F2, 0x2525),
+    'read_write': pdu(0x17, 'HHHHBHH', 0, 4, 16, 2, 4, 0x3F9D, 0xF3B6),
+    'read_fifo': pdu(0x18, 'H', 18),
+    'read_bank': pdu(0x03, 'HH', 21, 8),
+    'read_callback': pdu(0x03, 'HH', 28, 10),
+    'write_callback': pdu(0x10, 'HHBHHH', 31, 3, 6, 1, 2, 3),
+    'diagnostics_echo': pdu(0x08, 'HH', 0x00, 0xA537),
+    'diagnostics_restart': pdu(0x08, 'HH', 0x01, 0xFF00),
+    'diagnostics_counters': pdu(0x08, 'HH', 0x0B, 0x0000),
+    'comm_event_counter': pdu(0x0B),
+    'comm_event_log': pdu(0x0C),
+    'device_identification': pdu(0x2B, 'BBB', 0x0E, 0x01, 0x00),
+    'device_identification_extended': pdu(0x2B, 'BBB', 0x0E, 0x03, 0x00),
+    'device_identification_object': pdu(0x2B, 'BBB', 0x0E, 0x04, 0x80),
+    'unknown_function': pdu(0x41, 'HH', 0, 1),
+    'empty': b'',
+}
+
+# pipelined, and answered through buffers too small for the response.
+POLL_STREAMS = {
+    'pipelined_writes': record(POLL['write_register']) + record(POLL['write_coils']) + record(POLL['mask_write']),
+    'pipelined_reads': record(POLL['read_holding']) + record(POLL['read_fifo']) + record(POLL['read_bank']),
+    'short_response': record(POLL['read_holding_max'], 32) + record(POLL['read_coils'], 1),
+    'no_response': record(POLL['read_write'], 0) + record(POLL['diagnostics_echo'], 2),
+    'device_identification_follows': record(POLL['device_identification_extended'], 100) + record(POLL['device_identification_object'], 40),
+}
+
+# uModbusMaster::decode_response(): planned request index, pdu.
+MASTER = {
+    'coils': bytes([0]) + pdu(0x01, 'BBBB', 3, 0x05, 0x81, 0x0F),
+    'discrete_inputs': bytes([1]) + pdu(0x02, 'BBBB', 3, 0xFF, 0x00, 0x81),
+    'holding': bytes([2]) + pdu(0x03, 'B' + 'H' * 17, 34, *range(17)),
+    'holding_short': bytes([3]) + pdu(0x03, 'BHH', 8, 0x1234, 0x5678),
+    'input': bytes([4]) + pdu(0x04, 'B' + 'H' * 32, 64, *range(32)),
+    'exception': bytes([2]) + pdu(0x83, 'B', 0x02),
+    'wrong_function': bytes([0]) + pdu(0x03, 'BH', 2, 0xAAAA),
+}
+
+
+def write(harness, seeds):
+    path = os.path.join(HERE, 'corpus', harness)
+    os.makedirs(path, exist_ok=True)
+
+    for name, data in sorted(seeds.items()):
+        with open(os.path.join(path, name), 'wb') as file:
+            file.write(data)
+
+
+if __name__ == '__main__':
+    poll = dict((name, record(data)) for name, data in POLL.items())
+    poll.update(POLL_STREAMS)
+    write('umodbus_poll_fuzz', poll)
+    write('umodbus_master_fuzz', MASTER)
@@ -0,0 +1,138 @@
+/*
+Copyright 2020 Jerson Leonardo Huerfano Romero
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <dirent.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+// Driver for compilers without libFuzzer. Replays every file, or every file
+// in the directories, named on the command line through the harness. With
+// -runs=N it then runs N random mutations of those inputs, a poor man's
+// fuzzer that still finds shallow bugs under the sanitizers. Either way it
+// reports how many inputs per second the harness took.
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t * data, size_t size);
+
+typedef std::vector<uint8_t> input_t;
+
+static bool load_file(const std::string & path, std::vector<input_t> & inputs) {
+    FILE * file = fopen(path.c_str(), "rb");
+    input_t input;
+    int c;
+
+    if(file == 0) {
+        return false;
+    }
+
+    while((c = fgetc(file)) != EOF) {
+        input.push_back((uint8_t)c);
+    }
+
+    fclose(file);
+    inputs.push_back(input);
+    return true;
+}
+
+static bool load(const std::string & path, std::vector<input_t> & inputs) {
+    DIR * dir = opendir(path.c_str());
+    struct dirent * entry;
+
+    if(dir == 0) {
+        return load_file(path, inputs);
+    }
+
+    while((entry = readdir(dir)) != 0) {
+        if(entry->d_name[0] != '.') {
+            load_file(path + "/" + entry->d_name, inputs);
+        }
+    }
+
+    closedir(dir);
+    return true;
+}
+
+static void mutate(input_t & input) {
+    size_t edits = 1 + rand() % 4;
+
+    for(size_t i = 0; i < edits; i++) {
+        size_t at = input.empty() ? 0 : rand() % input.size();
+
+        switch(input.empty() ? 2 : rand() % 5) {
+        case 0: 
+            input[at] ^= (uint8_t)(1 << (rand() % 8)); 
+            break;
+        case 1: 
+            input[at] = (uint8_t)rand(); 
+            break;
+        case 2: 
+            input.insert(input.begin() + at, (uint8_t)rand()); 
+            break;
+        case 3: 
+            input.erase(input.begin() + at); 
+            break;
+        default: 
+            // the interesting values for lengths, counts and addresses.
+            input[at] = (rand() & 1) ? 0xFF : 0x00; 
+            break;
+        }
+    }
+}
+
+int main(int argc, char ** argv) {
+    std::vector<input_t> inputs;
+    unsigned long runs = 0;
+    unsigned seed = 1;
+
+    for(int i = 1; i < argc; i++) {
+        if(strncmp(argv[i], "-runs=", 6) == 0) {
+            runs = strtoul(argv[i] + 6, 0, 10);
+        } else if(strncmp(argv[i], "-seed=", 6) == 0) {
+            seed = (unsigned)strtoul(argv[i] + 6, 0, 10);
+        } else if(!load(argv[i], inputs)) {
+            fprintf(stderr, "can not open %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    if(inputs.empty()) {
+        inputs.push_back(input_t());
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    for(size_t i = 0; i < inputs.size(); i++) {
+        LLVMFuzzerTestOneInput(inputs[i].data(), inputs[i].size());
+    }
+
+    srand(seed);
+
+    for(unsigned long i = 0; i < runs; i++) {
+        input_t input = inputs[rand() % inputs.size()];
+
+        mutate(input);
+        LLVMFuzzerTestOneInput(input.data(), input.size());
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    unsigned long executed = inputs.size() + runs;
+
+    printf("executed %lu inputs in %.3f s, %.0f exec/s\n", executed, seconds, seconds > 0 ? executed / seconds : 0.0);
+    return 0;
+}
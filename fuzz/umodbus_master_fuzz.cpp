@@ -0,0 +1,60 @@
+/*
+Copyright 2020 Jerson Leonardo Huerfano Romero
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <stddef.h>
+#include <stdint.h>
+
+#include "umodbus_master.h"
+
+// Feeds arbitrary bytes to uModbusMaster::decode_response(). The first byte
+// picks the planned request the bytes claim to answer.
+
+static uint16_t words[64];
+static uint8_t bits[8];
+
+static umodbus::register_t registers[] = {
+    { 0, UMODBUS_TYPE_COIL, words + 0 },
+    { 2, UMODBUS_TYPE_COIL_BITS, (uint16_t *)bits, 20 },
+    { 0, UMODBUS_TYPE_DISCRETE_INPUT, words + 1 },
+    { 40, UMODBUS_TYPE_DISCRETE_INPUT_BITS, (uint16_t *)bits + 2, 12 },
+    { 0, UMODBUS_TYPE_HOLDING_REGISTER, words + 2, 16 },
+    { 20, UMODBUS_TYPE_HOLDING_REGISTER, words + 18 },
+    { 200, UMODBUS_TYPE_HOLDING_REGISTER, words + 19, 4 },
+    { 0, UMODBUS_TYPE_INPUT_REGISTER, words + 24, 32 },
+};
+
+static umodbus::read_request_t requests[8];
+
+static umodbus::uModbusMaster * create_master() {
+    static umodbus::uModbusMaster master(registers, sizeof(registers) / sizeof(registers[0]), 
+        requests, sizeof(requests) / sizeof(requests[0]));
+
+    if(!master.plan()) {
+        __builtin_trap();
+    }
+
+    return &master;
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t * data, size_t size) {
+    static umodbus::uModbusMaster * master = create_master();
+
+    if(size < 1) {
+        return 0;
+    }
+
+    master->decode_response(data[0] % master->get_request_count(), data + 1, size - 1);
+    return 0;
+}
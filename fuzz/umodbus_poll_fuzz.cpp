@@ -0,0 +1,152 @@
+/*
+Copyright 2020 Jerson Leonardo Huerfano Romero
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <stddef.h>
+#include <stdint.h>
+
+#include "umodbus.h"
+#include "umodbus_bank.h"
+#include "umodbus_fifo.h"
+
+// Drives uModbus::poll() with arbitrary bytes. The input is a stream of
+// records: one byte of response capacity, one byte of PDU length and the
+// PDU itself, so a single input covers pipelined requests and responses
+// cut short. The map holds every storage kind the handlers branch on.
+
+class FuzzServer : public umodbus::uModbus {
+public:
+    const uint8_t * data;
+    size_t size;
+    size_t capacity;
+    uint8_t response_buffer[UMODBUS_MAX_PDU_SIZE];
+
+    FuzzServer(umodbus::register_t * buff, const size_t & len) : uModbus(1, buff, len), data(0), size(0), capacity(0) { }
+
+    void feed(const uint8_t * data, const size_t & size) {
+        this->data = data;
+        this->size = size;
+        this->poll();
+    }
+
+protected:
+    virtual bool prepare_response(umodbus::frame_t & request, umodbus::frame_t & response) {
+        size_t length;
+
+        if(this->size < 2) {
+            return false;
+        }
+
+        this->capacity = (this->data[0] < sizeof(this->response_buffer)) ? this->data[0] : sizeof(this->response_buffer);
+        length = (this->data[1] < this->size - 2) ? this->data[1] : this->size - 2;
+
+        request.ptr = (uint8_t *)this->data + 2;
+        request.size = length;
+        response.ptr = this->response_buffer;
+        response.size = this->capacity;
+
+        this->data += 2 + length;
+        this->size -= 2 + length;
+        return true;
+    }
+
+    virtual void send(const umodbus::frame_t & response) {
+        if(response.size > this->capacity) {
+            __builtin_trap();
+        }
+    }
+};
+
+static uint16_t words[64];
+static uint8_t bits[8];
+static uint32_t value;
+static uint16_t bank_storage[16];
+static umodbus::umodbus_bank_t bank;
+static umodbus::umodbus_fifo_t fifo;
+static uint16_t computed[8];
+
+static bool read_computed(void * context, const uint16_t & address, uint8_t * dst, const uint16_t & count) {
+    if(address < 30 || address + count > 38) {
+        __builtin_trap();
+    }
+
+    for(uint16_t i = 0; i < count; i++) {
+        umodbus::umodbus_store_u16(dst + i * 2, computed[address - 30 + i]);
+    }
+
+    return (address & 1) == 0;
+}
+
+static bool write_computed(void * context, const uint16_t & address, const uint8_t * src, const uint16_t & count) {
+    if(address < 30 || address + count > 38) {
+        __builtin_trap();
+    }
+
+    for(uint16_t i = 0; i < count; i++) {
+        computed[address - 30 + i] = umodbus::umodbus_load_u16(src + i * 2);
+    }
+
+    return count < 4;
+}
+
+static umodbus::umodbus_callbacks_t callbacks = { read_computed, write_computed, 0 };
+
+static umodbus::register_t registers[] = {
+    { 0, UMODBUS_TYPE_COIL, words + 0 },
+    { 1, UMODBUS_TYPE_COIL_BITS, (uint16_t *)bits, 32 },
+    { 0, UMODBUS_TYPE_DISCRETE_INPUT, words + 1 },
+    { 1, UMODBUS_TYPE_DISCRETE_INPUT_BITS, (uint16_t *)bits, 16 },
+    { 0, UMODBUS_TYPE_HOLDING_REGISTER, words + 2, 16 },
+    umodbus::umodbus_bind_value(16, UMODBUS_TYPE_HOLDING_REGISTER, value),
+    { 18, UMODBUS_TYPE_HOLDING_REGISTER_FIFO, UMODBUS_FIFO_PTROF(fifo), 1 },
+    { 20, UMODBUS_TYPE_HOLDING_REGISTER, words + 18 },
+    { 21, UMODBUS_TYPE_HOLDING_REGISTER_BANK, UMODBUS_BANK_PTROF(bank), 8 },
+    { 30, UMODBUS_TYPE_HOLDING_REGISTER_CALLBACK, UMODBUS_CALLBACKS_PTROF(callbacks), 8 },
+    { 0, UMODBUS_TYPE_INPUT_REGISTER, words + 20, 32 },
+};
+
+static const umodbus::device_object_t device_objects[] = {
+    { UMODBUS_OBJECT_VENDOR_NAME, "uModbus" },
+    { UMODBUS_OBJECT_PRODUCT_CODE, "FUZZ" },
+    { UMODBUS_OBJECT_REVISION, "1.0" },
+    { UMODBUS_OBJECT_PRODUCT_NAME, "poll() harness" },
+    { 0x80, "0123456789012345678901234567890123456789012345678901234567890123" },
+    { 0x81, "0123456789012345678901234567890123456789012345678901234567890123" },
+    { 0xFF, "" }
+};
+static uint8_t device_id[256];
+
+static void on_written(void * context, const umodbus::write_range_t * ranges, const size_t & count) {
+    if(count == 0 || count > UMODBUS_WRITE_RANGES) {
+        __builtin_trap();
+    }
+}
+
+static FuzzServer * create_server() {
+    static FuzzServer server(registers, sizeof(registers) / sizeof(registers[0]));
+
+    umodbus::umodbus_bank_init(&bank, bank_storage, 8);
+    umodbus::umodbus_fifo_init(&fifo);
+    server.set_write_callback(on_written);
+    server.set_device_identification(device_objects, sizeof(device_objects) / sizeof(device_objects[0]), device_id, sizeof(device_id));
+    return &server;
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t * data, size_t size) {
+    static FuzzServer * server = create_server();
+
+    umodbus::umodbus_fifo_push(&fifo, (uint16_t)size);
+    server->feed(data, size);
+    return 0;
+}
@@ -1,39 +1,338 @@
 #include <string.h>
 #include "umodbus.h"
+#include "umodbus_fifo.h"
+#include "umodbus_bank.h"
+
+#ifdef UMODBUS_STATS
+#if defined(ARDUINO)
+#include <Arduino.h>
+#define UMODBUS_STATS_CLOCK()       ((uint32_t)micros())
+#else
+#include <time.h>
+
+static inline uint32_t stats_clock() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint32_t)(now.tv_sec * 1000000UL + now.tv_nsec / 1000);
+}
+
+#define UMODBUS_STATS_CLOCK()       stats_clock()
+#endif
+#endif
 
 namespace umodbus {
 
-uint8_t umodbus_get_endianness() {
-    uint16_t i = 0x00FF;
-    uint8_t * ptr = (uint8_t*)&i;
-    return *ptr == 0x00 ? UMODBUS_BIG_ENDIAN : UMODBUS_LITTLE_ENDIAN;
+void umodbus_copy_to_wire(uint8_t * dst, const uint16_t * src, const size_t & count) {
+#if UMODBUS_HOST_ENDIANNESS == UMODBUS_LITTLE_ENDIAN
+    for(size_t i = 0; i < count; i++) {
+        uint16_t val = UMODBUS_BSWAP16(src[i]);
+        memcpy(dst + i * 2, &val, 2);
+    }
+#else
+    memcpy(dst, src, count * 2);
+#endif
+}
+
+void umodbus_copy_from_wire(uint16_t * dst, const uint8_t * src, const size_t & count) {
+#if UMODBUS_HOST_ENDIANNESS == UMODBUS_LITTLE_ENDIAN
+    for(size_t i = 0; i < count; i++) {
+        uint16_t val;
+        memcpy(&val, src + i * 2, 2);
+        dst[i] = UMODBUS_BSWAP16(val);
+    }
+#else
+    memmove(dst, src, count * 2);
+#endif
+}
+
+// byte of a UMODBUS_STORAGE_VALUE variable that goes at position k of its
+// wire image, the most significant word first unless UMODBUS_WORDS_LOW_FIRST.
+static inline size_t value_byte(const register_t * reg, const size_t & k) {
+    size_t size = UMODBUS_GET_COUNT(reg) * 2;
+    size_t significance = UMODBUS_IS_LOW_WORD_FIRST(reg) ? (k ^ 1) : (size - 1 - k);
+
+#if UMODBUS_HOST_ENDIANNESS == UMODBUS_LITTLE_ENDIAN
+    return significance;
+#else
+    return size - 1 - significance;
+#endif
+}
+
+void umodbus_value_to_wire(uint8_t * dst, const register_t * reg, const size_t & offset, const size_t & count) {
+    const uint8_t * value = (const uint8_t *)UMODBUS_VALUEOF(reg);
+
+    for(size_t k = offset * 2; k < (offset + count) * 2; k++) {
+        *dst++ = value[value_byte(reg, k)];
+    }
+}
+
+void umodbus_value_from_wire(const register_t * reg, const size_t & offset, const uint8_t * src, const size_t & count) {
+    uint8_t * value = (uint8_t *)UMODBUS_VALUEOF(reg);
+
+    for(size_t k = offset * 2; k < (offset + count) * 2; k++) {
+        value[value_byte(reg, k)] = *src++;
+    }
+}
+
+static inline void copy_bit(uint8_t * dst, const size_t & dst_bit, const uint8_t * src, const size_t & src_bit) {
+    uint8_t mask = (uint8_t)(1 << (dst_bit & 7));
+
+    if((src[src_bit >> 3] >> (src_bit & 7)) & 1) {
+        dst[dst_bit >> 3] |= mask;
+    } else {
+        dst[dst_bit >> 3] &= (uint8_t)~mask;
+    }
+}
+
+void umodbus_copy_bits(uint8_t * dst, const size_t & dst_bit, const uint8_t * src, const size_t & src_bit, const size_t & count) {
+    size_t i = 0;
+    size_t shift;
+    size_t bytes;
+    const uint8_t * from;
+    uint8_t * to;
+
+    // single bits until the destination is byte aligned.
+    for(; i < count && ((dst_bit + i) & 7) != 0; i++) {
+        copy_bit(dst, dst_bit + i, src, src_bit + i);
+    }
+
+    // whole destination bytes, shifting the source into place when it is not aligned.
+    shift = (src_bit + i) & 7;
+    bytes = (count - i) / 8;
+    from = src + ((src_bit + i) >> 3);
+    to = dst + ((dst_bit + i) >> 3);
+
+    if(shift == 0) {
+        memcpy(to, from, bytes);
+    } else {
+        for(size_t k = 0; k < bytes; k++) {
+            to[k] = (uint8_t)((from[k] >> shift) | (from[k + 1] << (8 - shift)));
+        }
+    }
+
+    for(i += bytes * 8; i < count; i++) {
+        copy_bit(dst, dst_bit + i, src, src_bit + i);
+    }
+}
+
+static inline uint32_t register_key(const register_t * reg) {
+    return (((uint32_t)UMODBUS_GET_TABLE(reg)) << 16) | reg->address;
+}
+
+// sorted by (table, address) without overlapping blocks.
+static bool umodbus_disjoint_registers(const register_table_t * all) {
+    register_t entry;
+    uint32_t end = 0;
+
+    for(size_t i = 0; i < all->size; i++) {
+        const register_t * reg_i = umodbus_get_entry(all, i, entry);
+
+        if(register_key(reg_i) < end) {
+            return false;
+        }
+
+        end = register_key(reg_i) + UMODBUS_GET_COUNT(reg_i);
+    }
+
+    return true;
 }
 
 uModbus::uModbus() {
     this->reg = 0;
     this->unit_id = 0;
     this->reg_size = 0;
+    memset(this->tables, 0, sizeof(this->tables));
+    this->bind(0, 0, 0, 0);
+    this->set_write_callback(0);
+    this->set_device_identification(0, 0, 0, 0);
+    this->polling = false;
+#ifdef UMODBUS_STATS
+    this->reset_stats();
+#endif
 }
 
 uModbus::uModbus(const uint8_t &unit_id, register_t * buff, const size_t & len) {
-    this->reg = buff;
-    this->reg_size = len;
     this->unit_id = unit_id;
+    memset(this->tables, 0, sizeof(this->tables));
+    this->set_registers(buff, len);
+    this->bind(0, 0, 0, 0);
+    this->set_write_callback(0);
+    this->set_device_identification(0, 0, 0, 0);
+    this->polling = false;
+#ifdef UMODBUS_STATS
+    this->reset_stats();
+#endif
+}
+
+uint8_t uModbus::get_unit_id() {
+    return this->unit_id;
 }
 
-register_t * uModbus::get_registers() {
+const register_t * uModbus::get_registers() {
     return this->reg;
 }
 
-void uModbus::set_registers(register_t * buff, const size_t & len) {
+register_table_t * uModbus::get_table(const uint8_t & table) {
+    return (table < UMODBUS_TABLE_COUNT) ? (this->tables + table) : 0;
+}
+
+bool uModbus::set_table(const uint8_t & table, const register_t * buff, const size_t & len) {
+    register_table_t all = { buff, len, 0, false, 0, 0, false };
+    bool ok = table < UMODBUS_TABLE_COUNT && umodbus_disjoint_registers(&all);
+
+    if(table < UMODBUS_TABLE_COUNT) {
+        this->layout_table(this->tables + table, ok ? buff : 0, ok ? len : 0, false);
+    }
+
+    return ok;
+}
+
+void uModbus::layout_table(register_table_t * t, const register_t * buff, const size_t & len, const bool & progmem) {
+    register_t entry;
+
+    t->reg = buff;
+    t->size = len;
+    t->progmem = progmem;
+    t->index = 0;
+    t->span = 0;
+    t->base = (len > 0) ? umodbus_get_entry(t, 0, entry)->address : 0;
+    t->dense = len > 0;
+
+    // base + offset only when entry i is the single point at base + i.
+    for(size_t i = 0; i < len && t->dense; i++) {
+        const register_t * reg_i = umodbus_get_entry(t, i, entry);
+        t->dense = reg_i->address == t->base + i && UMODBUS_GET_COUNT(reg_i) == 1;
+    }
+}
+
+void umodbus_sort_registers(register_t * buff, const size_t & len) {
+    for(size_t i = 1; i < len; i++) {
+        register_t key = buff[i];
+        size_t j = i;
+
+        while(j > 0 && register_key(buff + j - 1) > register_key(&key)) {
+            buff[j] = buff[j - 1];
+            j--;
+        }
+        buff[j] = key;
+    }
+}
+
+void uModbus::set_write_callback(write_callback_t callback, void * context) {
+    this->write_callback = callback;
+    this->write_context = context;
+    this->write_count = 0;
+}
+
+#ifdef UMODBUS_STATS
+const umodbus_stats_t * uModbus::get_stats() {
+    return &(this->stats);
+}
+
+void uModbus::reset_stats() {
+    memset(&(this->stats), 0, sizeof(this->stats));
+}
+#endif
+
+bool uModbus::set_registers(register_t * buff, const size_t & len) {
+    register_table_t all = { buff, len, 0, false, 0, 0, false };
+
+    // sort the flat map in place by (table, address) so every table becomes a slice of it.
+    umodbus_sort_registers(buff, len);
+
+    // duplicate or overlapping addresses would make lookups return the wrong block.
+    if(!umodbus_disjoint_registers(&all)) {
+        this->split_tables(0, 0, false);
+        return false;
+    }
+
+    this->split_tables(buff, len, false);
+    return true;
+}
+
+bool uModbus::set_registers_P(const register_t * buff, const size_t & len) {
+    register_table_t flash = { buff, len, 0, false, 0, 0, true };
+
+    // flash can not be sorted in place, check the order instead.
+    if(!umodbus_disjoint_registers(&flash)) {
+        this->split_tables(0, 0, false);
+        return false;
+    }
+
+    this->split_tables(buff, len, true);
+    return true;
+}
+
+void uModbus::split_tables(const register_t * buff, const size_t & len, const bool & progmem) {
+    register_table_t all = { buff, len, 0, false, 0, 0, progmem };
+    register_t entry;
+    size_t first = 0;
+
     this->reg = buff;
     this->reg_size = len;
+
+    for(uint8_t t = 0; t < UMODBUS_TABLE_COUNT; t++) {
+        size_t last = first;
+
+        while(last < len && UMODBUS_GET_TABLE(umodbus_get_entry(&all, last, entry)) == t) {
+            last++;
+        }
+
+        this->layout_table(this->tables + t, buff + first, last - first, progmem);
+        first = last;
+    }
+}
+
+void uModbus::set_map(const register_map_t & map) {
+    register_map_t copy;
+
+    UMODBUS_PGM_COPY(&copy, &map, sizeof(copy));
+    this->reg = copy.reg;
+    this->reg_size = copy.size;
+    memcpy(this->tables, copy.tables, sizeof(this->tables));
+}
+
+void uModbus::bind(const uint8_t * request, const size_t & len, uint8_t * response, const size_t & size) {
+    this->rx_ptr = request;
+    this->rx_size = len;
+    this->rx_cursor = 0;
+    this->rx_truncated = false;
+    this->tx_ptr = response;
+    this->tx_size = size;
+    this->tx_cursor = 0;
+    this->tx_failed = false;
 }
 
 void uModbus::poll() {
-    if(this->prepare_response()) {
+    frame_t request;
+    frame_t response;
+
+    // pipelined requests are answered first, the application hears of their writes at once.
+    this->polling = true;
 
+    while(this->prepare_response(request, response)) {
+#ifdef UMODBUS_STATS
+        uint32_t start = UMODBUS_STATS_CLOCK();
+#endif
+        response.size = this->process(request.ptr, request.size, response.ptr, response.size);
+        this->send(response);
+#ifdef UMODBUS_STATS
+        this->stats.latency[umodbus_stats_bucket(UMODBUS_STATS_CLOCK() - start)]++;
+#endif
+    }
+
+    this->polling = false;
+    this->notify_written();
+}
+
+size_t uModbus::process(const uint8_t * request, const size_t & len, uint8_t * response, const size_t & size) {
+    this->bind(request, len, response, size);
+
+    if(len > 0) {
         uint8_t fnc = this->read();
+#ifdef UMODBUS_STATS
+        uint32_t start = UMODBUS_STATS_CLOCK();
+#endif
 
         switch (fnc)
         {
@@ -61,28 +360,62 @@ void uModbus::poll() {
         case UMODBUS_FNCODE_RW_M_REG:
             this->read_write_as_register(fnc);
             break;
+        case UMODBUS_FNCODE_MSK_WR_REG:
+            this->mask_write_as_register(fnc);
+            break;
+        case UMODBUS_FNCODE_RD_FIFO_QUEUE:
+            this->read_fifo_as_register(fnc);
+            break;
         case UMODBUS_FNCODE_RD_DEV_ID:
             this->read_mei_type(fnc);
             break;
+#ifdef UMODBUS_STATS
+        case UMODBUS_FNCODE_DIAGNOSTICS:
+            this->diagnostics(fnc);
+            break;
+        case UMODBUS_FNCODE_GET_COMM_EV_CNTR:
+            this->get_comm_event_counter(fnc);
+            break;
+        case UMODBUS_FNCODE_GET_COMM_EV_LOG:
+            this->get_comm_event_log(fnc);
+            break;
+#else
         case UMODBUS_FNCODE_DIAGNOSTICS:
+        case UMODBUS_FNCODE_GET_COMM_EV_CNTR:
+        case UMODBUS_FNCODE_GET_COMM_EV_LOG:
+#endif
         case UMODBUS_FNCODE_RD_EXCEPTION_STATUS:
         case UMODBUS_FNCODE_RD_FILE_RECORD:
-        case UMODBUS_FNCODE_RD_FIFO_QUEUE:
         case UMODBUS_FNCODE_WR_FILE_RECORD:
-        case UMODBUS_FNCODE_GET_COMM_EV_CNTR:
-        case UMODBUS_FNCODE_GET_COMM_EV_LOG:
         case UMODBUS_FNCODE_REPORT_SVR_ID:
-        case UMODBUS_FNCODE_MSK_WR_REG:
         default: 
             this->execute_function(fnc);
             break;
         }
 
-        this->send();
+        // never send a truncated or half computed response. report a server device failure instead.
+        if(this->tx_failed) {
+            this->tx_cursor = 0;
+            this->tx_failed = false;
+            this->write(fnc + 0x80);
+            this->write(0x04);
+            this->tx_cursor = this->tx_failed ? 0 : this->tx_cursor;
+        }
+
+#ifdef UMODBUS_STATS
+        this->record_stats(fnc, len, UMODBUS_STATS_CLOCK() - start);
+#endif
+    }
+
+    if(!this->polling) {
+        this->notify_written();
     }
+
+    return this->tx_cursor;
 }
 
 void uModbus::read_as_byte(const uint8_t & fnc) {
+    uint8_t table = (fnc == UMODBUS_FNCODE_RD_M_DISCRETE_INPUT) ? UMODBUS_TABLE_DISCRETE_INPUT : UMODBUS_TABLE_COIL;
     uint16_t startingAddress = 0;
     uint16_t inputCount = 0;
     size_t regIndex = 0;
@@ -90,32 +423,43 @@ void uModbus::read_as_byte(const uint8_t & fnc) {
     this->read_data(startingAddress);
     this->read_data(inputCount);
     
-    if(0x0000 <= inputCount && inputCount <= 0x07D0) {
-        regIndex = this->binary_search(startingAddress);
+    if(!this->rx_truncated && 0x0001 <= inputCount && inputCount <= 0x07D0) {
+        regIndex = this->find_range(table, startingAddress, inputCount);
+
+        if(regIndex != SIZE_MAX) {
+            register_t entry;
+            uint8_t * status;
 
-        if(regIndex != SIZE_MAX && (regIndex + inputCount) <= reg_size) {
-            uint8_t status[UMODBUS_TOPDIV(inputCount, 8)];
-            bool success = true;
+            this->write(fnc);
+            this->write((uint8_t) UMODBUS_TOPDIV(inputCount, 8));
+            status = this->reserve(UMODBUS_TOPDIV(inputCount, 8));
 
-            for(uint16_t i = 0; i < inputCount; i++) {
-                register_t * reg_i = reg + regIndex + i;
-                status[i / 8] = ((i % 8) == 0) ? 0 : status[i / 8];
+            if(status != 0) {
+                memset(status, 0, UMODBUS_TOPDIV(inputCount, 8));
+            }
 
-                if(UMODBUS_GET_SIZE(reg_i) == UMODBUS_SIZE_COIL) {
-                    status[i / 8] |= (*UMODBUS_VALUEOF(reg_i) == UMODBUS_COIL_OFF)? 0 : (1 << (i % 8));
-                } else {
-                    success = false;
+            for(uint16_t i = 0; status != 0 && i < inputCount; regIndex++) {
+                const register_t * reg_i = umodbus_get_entry(this->tables + table, regIndex, entry);
+                uint16_t offset = (i == 0) ? startingAddress - reg_i->address : 0;
+                uint16_t n = UMODBUS_GET_COUNT(reg_i) - offset;
+                n = (n < inputCount - i) ? n : (inputCount - i);
+
+                // only a corrupt table yields an empty segment, it would never advance.
+                if(n == 0) {
+                    this->tx_failed = true;
                     break;
                 }
-            }
 
-            if(success) {
-                this->write(fnc);
-                this->write((uint8_t) UMODBUS_TOPDIV(inputCount, 8));
-                this->write(status, UMODBUS_TOPDIV(inputCount, 8));
-            } else {
-                this->write(fnc + 0x80);
-                this->write(0x04);
+                if(UMODBUS_GET_STORAGE(reg_i) == UMODBUS_STORAGE_BITS) {
+                    umodbus_copy_bits(status, i, UMODBUS_BITSOF(reg_i), offset, n);
+                    i += n;
+                } else {
+                    uint16_t * value = UMODBUS_VALUEOF(reg_i) + offset;
+
+                    for(uint16_t j = 0; j < n; j++, i++) {
+                        status[i / 8] |= (value[j] == UMODBUS_COIL_OFF)? 0 : (1 << (i % 8));
+                    }
+                }
             }
         } else {
             this->write(fnc + 0x80);
@@ -128,6 +472,7 @@ void uModbus::read_as_byte(const uint8_t & fnc) {
 }
 
 void uModbus::read_as_register(const uint8_t & fnc) {
+    uint8_t table = (fnc == UMODBUS_FNCODE_RD_M_INPUT_REG) ? UMODBUS_TABLE_INPUT_REGISTER : UMODBUS_TABLE_HOLDING_REGISTER;
     uint16_t startingAddress;
     uint16_t inputCount;
     size_t regIndex;
@@ -135,34 +480,18 @@ void uModbus::read_as_register(const uint8_t & fnc) {
     this->read_data(startingAddress);
     this->read_data(inputCount);
 
-    if(0x0001 <= inputCount && inputCount <= 0x007D) {
-        regIndex = this->binary_search(startingAddress);
-        if(regIndex != SIZE_MAX && (regIndex + inputCount) <= reg_size) {
-            uint16_t status[inputCount];
-            bool success = true;
-
-            for(uint16_t i = 0; i < inputCount; i++) {
-                register_t * reg_i = reg + regIndex + i;
-                uint8_t type = UMODBUS_GET_SIZE(reg_i);
-                if(type == UMODBUS_SIZE_REGISTER) {
-                    uint16_t val = *UMODBUS_VALUEOF(reg_i);
-                    if(umodbus_get_endianness() == UMODBUS_LITTLE_ENDIAN) {
-                        val = (val >> 8) + (val << 8);
-                    }
-                    memcpy(status + i, UMODBUS_PTROF(val), 2);
-                } else {
-                    success = false;
-                    break;
-                }
-            }
+    if(!this->rx_truncated && 0x0001 <= inputCount && inputCount <= 0x007D) {
+        regIndex = this->find_range(table, startingAddress, inputCount);
 
-            if(success) {
-                this->write(fnc);
-                this->write((uint8_t) inputCount * 2);
-                this->write((uint8_t*) status, inputCount * 2);
-            } else {
-                this->write(fnc + 0x80);
-                this->write(0x04);
+        if(regIndex != SIZE_MAX) {
+            uint8_t * status;
+
+            this->write(fnc);
+            this->write((uint8_t) (inputCount * 2));
+            status = this->reserve(inputCount * 2);
+
+            if(status != 0) {
+                this->load_registers(table, regIndex, startingAddress, inputCount, status);
             }
         } else {
             this->write(fnc + 0x80);
@@ -182,22 +511,25 @@ void uModbus::write_single_as_byte(const uint8_t & fnc) {
     this->read_data(address);
     this->read_data(value);
 
-    if(value == UMODBUS_COIL_ON || value == UMODBUS_COIL_OFF) {
-        regIndex = this->binary_search(address);
+    if(!this->rx_truncated && (value == UMODBUS_COIL_ON || value == UMODBUS_COIL_OFF)) {
+        regIndex = this->find_register(UMODBUS_TABLE_COIL, address);
 
         if(regIndex != SIZE_MAX) {
-            register_t * reg_i = this->reg + regIndex;
-
-            if(UMODBUS_GET_SIZE(reg_i) == UMODBUS_SIZE_COIL) {
-                *UMODBUS_VALUEOF(reg_i) = value;
+            register_t entry;
+            const register_t * reg_i = umodbus_get_entry(this->tables + UMODBUS_TABLE_COIL, regIndex, entry);
+            uint16_t offset = address - reg_i->address;
 
-                this->write(fnc);
-                this->write_data(address);
-                this->write_data(value);
+            if(UMODBUS_GET_STORAGE(reg_i) == UMODBUS_STORAGE_BITS) {
+                uint8_t bit = (value == UMODBUS_COIL_ON) ? 1 : 0;
+                umodbus_copy_bits(UMODBUS_BITSOF(reg_i), offset, &bit, 0, 1);
             } else {
-                this->write(fnc + 0x80);
-                this->write(0x04);
+                *(UMODBUS_VALUEOF(reg_i) + offset) = value;
             }
+
+            this->mark_written(UMODBUS_TABLE_COIL, address, 1);
+            this->write(fnc);
+            this->write_data(address);
+            this->write_data(value);
         } else {
             this->write(fnc + 0x80);
             this->write(0x02);
@@ -216,24 +548,25 @@ void uModbus::write_single_as_register(const uint8_t & fnc) {
     this->read_data(address);
     this->read_data(value);
     
-    regIndex = this->binary_search(address);
+    if(!this->rx_truncated) {
+        regIndex = this->find_register(UMODBUS_TABLE_HOLDING_REGISTER, address);
 
-    if(regIndex != SIZE_MAX && (this->reg + regIndex)->type == UMODBUS_SIZE_REGISTER) {
-        register_t * reg_i = this->reg + regIndex;
+        if(regIndex != SIZE_MAX && this->writable_range(UMODBUS_TABLE_HOLDING_REGISTER, regIndex, address, 1)) {
+            uint8_t buff[2];
 
-        if(UMODBUS_GET_SIZE(reg_i) == UMODBUS_SIZE_REGISTER) {
-            memcpy(UMODBUS_VALUEOF(reg_i), &value, 2);
+            umodbus_store_u16(buff, value);
+            this->store_registers(UMODBUS_TABLE_HOLDING_REGISTER, regIndex, address, 1, buff);
 
             this->write(fnc);
             this->write_data(address);
             this->write_data(value);
         } else {
             this->write(fnc + 0x80);
-            this->write(0x04);
+            this->write(0x02);
         }
     } else {
         this->write(fnc + 0x80);
-        this->write(0x02);
+        this->write(0x03);
     }
 }
 
@@ -247,36 +580,45 @@ void uModbus::write_multiple_as_byte(const uint8_t & fnc) {
     this->read_data(outputCount);
     byteCount = this->read();
 
-    if(0x0001 <= outputCount && outputCount <= 0x07B0) {
-        regIndex = this->binary_search(address);
+    if(0x0001 <= outputCount && outputCount <= 0x07B0 
+        && byteCount == UMODBUS_TOPDIV(outputCount, 8) && this->available() >= byteCount) {
+        regIndex = this->find_range(UMODBUS_TABLE_COIL, address, outputCount);
 
-        if(regIndex != SIZE_MAX && (regIndex + outputCount) <= this->reg_size) {
-            uint8_t data[byteCount];
-            bool success = true;
+        if(regIndex != SIZE_MAX) {
+            register_t entry;
+            const uint8_t * data = this->rx_ptr + this->rx_cursor;
 
-            this->read(data, byteCount);
+            this->rx_cursor += byteCount;
 
-            for(uint16_t i = 0; i < outputCount; i++) {
-                uint8_t bk = data[i / 8];
-                register_t * reg_i = this->reg + regIndex + i;
+            for(uint16_t i = 0; i < outputCount; regIndex++) {
+                const register_t * reg_i = umodbus_get_entry(this->tables + UMODBUS_TABLE_COIL, regIndex, entry);
+                uint16_t offset = (i == 0) ? address - reg_i->address : 0;
+                uint16_t n = UMODBUS_GET_COUNT(reg_i) - offset;
+                n = (n < outputCount - i) ? n : (outputCount - i);
 
-                if(UMODBUS_GET_SIZE(reg_i) == UMODBUS_SIZE_COIL) {
-                    uint8_t bki = (bk & (1 << (i % 8)));
-                    *(reg_i->ptr) = bki > 0 ? UMODBUS_COIL_ON : UMODBUS_COIL_OFF;
-                } else {
-                    success = false;
+                // only a corrupt table yields an empty segment, it would never advance.
+                if(n == 0) {
+                    this->tx_failed = true;
                     break;
                 }
-            }
 
-            if(success) {
-                this->write(fnc);
-                this->write_data(address);
-                this->write_data(outputCount);
-            } else {
-                this->write(fnc + 0x80);
-                this->write(0x04);
+                if(UMODBUS_GET_STORAGE(reg_i) == UMODBUS_STORAGE_BITS) {
+                    umodbus_copy_bits(UMODBUS_BITSOF(reg_i), offset, data, i, n);
+                    i += n;
+                } else {
+                    uint16_t * value = UMODBUS_VALUEOF(reg_i) + offset;
+
+                    for(uint16_t j = 0; j < n; j++, i++) {
+                        uint8_t bki = (data[i / 8] & (1 << (i % 8)));
+                        value[j] = bki > 0 ? UMODBUS_COIL_ON : UMODBUS_COIL_OFF;
+                    }
+                }
             }
+
+            this->mark_written(UMODBUS_TABLE_COIL, address, outputCount);
+            this->write(fnc);
+            this->write_data(address);
+            this->write_data(outputCount);
         } else {
             this->write(fnc + 0x80);
             this->write(0x02);
@@ -297,33 +639,135 @@ void uModbus::write_multiple_as_register(const uint8_t & fnc) {
     this->read_data(outputCount);
     byteCount = this->read();
 
-    if(0x0001 <= outputCount && outputCount <= 0x007B) {
-        regIndex = this->binary_search(address);
+    if(0x0001 <= outputCount && outputCount <= 0x007B 
+        && byteCount == outputCount * 2 && this->available() >= byteCount) {
+        regIndex = this->find_range(UMODBUS_TABLE_HOLDING_REGISTER, address, outputCount);
+
+        if(regIndex != SIZE_MAX && this->writable_range(UMODBUS_TABLE_HOLDING_REGISTER, regIndex, address, outputCount)) {
+            // the payload is decoded straight from the request frame into each backing array.
+            this->store_registers(UMODBUS_TABLE_HOLDING_REGISTER, regIndex, address, outputCount, this->rx_ptr + this->rx_cursor);
+            this->rx_cursor += byteCount;
+
+            this->write(fnc);
+            this->write_data(address);
+            this->write_data(outputCount);
+        } else {
+            this->write(fnc + 0x80);
+            this->write(0x02);
+        }
+    } else {
+        this->write(fnc + 0x80);
+        this->write(0x03);
+    }
+}
+
+void uModbus::read_write_as_register(const uint8_t & fnc) {
+    uint16_t readAddress;
+    uint16_t readCount;
+    uint16_t writeAddress;
+    uint16_t writeCount;
+    uint8_t byteCount;
+    size_t readIndex;
+    size_t writeIndex;
+
+    this->read_data(readAddress);
+    this->read_data(readCount);
+    this->read_data(writeAddress);
+    this->read_data(writeCount);
+    byteCount = this->read();
+
+    if(!this->rx_truncated && 0x0001 <= readCount && readCount <= 0x007D 
+        && 0x0001 <= writeCount && writeCount <= 0x0079
+        && byteCount == writeCount * 2 && this->available() >= byteCount) {
+        readIndex = this->find_range(UMODBUS_TABLE_HOLDING_REGISTER, readAddress, readCount);
+        writeIndex = this->find_range(UMODBUS_TABLE_HOLDING_REGISTER, writeAddress, writeCount);
 
-        if(regIndex != SIZE_MAX && (regIndex + outputCount) <= this->reg_size) {
-            
-            bool success = true;
+        // both ranges are checked before anything is touched, so a rejected request changes nothing.
+        if(readIndex != SIZE_MAX && writeIndex != SIZE_MAX 
+            && this->writable_range(UMODBUS_TABLE_HOLDING_REGISTER, writeIndex, writeAddress, writeCount)) {
+            uint8_t * status;
 
-            for(uint16_t i = 0; i < outputCount; i++) {
-                uint16_t value;    
-                register_t * reg_i = this->reg + regIndex + i;
+            this->store_registers(UMODBUS_TABLE_HOLDING_REGISTER, writeIndex, writeAddress, writeCount, this->rx_ptr + this->rx_cursor);
+            this->rx_cursor += byteCount;
 
-                this->read_data(value);
+            this->write(fnc);
+            this->write((uint8_t) (readCount * 2));
+            status = this->reserve(readCount * 2);
 
-                if(success && UMODBUS_GET_SIZE(reg_i) == UMODBUS_SIZE_REGISTER) {
-                    *(reg_i->ptr) = value;
-                } else {
-                    success = false;
-                }
+            if(status != 0) {
+                this->load_registers(UMODBUS_TABLE_HOLDING_REGISTER, readIndex, readAddress, readCount, status);
             }
+        } else {
+            this->write(fnc + 0x80);
+            this->write(0x02);
+        }
+    } else {
+        this->write(fnc + 0x80);
+        this->write(0x03);
+    }
+}
 
-            if(success) {
-                this->write(fnc);
-                this->write_data(address);
-                this->write_data(outputCount);
-            } else {
-                this->write(fnc + 0x80);
-                this->write(0x04);
+void uModbus::mask_write_as_register(const uint8_t & fnc) {
+    uint16_t address;
+    uint16_t andMask;
+    uint16_t orMask;
+    size_t regIndex;
+
+    this->read_data(address);
+    this->read_data(andMask);
+    this->read_data(orMask);
+
+    if(!this->rx_truncated) {
+        regIndex = this->find_register(UMODBUS_TABLE_HOLDING_REGISTER, address);
+
+        if(regIndex != SIZE_MAX && this->writable_range(UMODBUS_TABLE_HOLDING_REGISTER, regIndex, address, 1)) {
+            uint8_t buff[2];
+            uint16_t value;
+
+            this->load_registers(UMODBUS_TABLE_HOLDING_REGISTER, regIndex, address, 1, buff);
+            value = umodbus_load_u16(buff);
+            umodbus_store_u16(buff, (value & andMask) | (orMask & ~andMask));
+            this->store_registers(UMODBUS_TABLE_HOLDING_REGISTER, regIndex, address, 1, buff);
+
+            this->write(fnc);
+            this->write_data(address);
+            this->write_data(andMask);
+            this->write_data(orMask);
+        } else {
+            this->write(fnc + 0x80);
+            this->write(0x02);
+        }
+    } else {
+        this->write(fnc + 0x80);
+        this->write(0x03);
+    }
+}
+
+void uModbus::read_fifo_as_register(const uint8_t & fnc) {
+    uint16_t address;
+    size_t regIndex;
+
+    this->read_data(address);
+
+    if(!this->rx_truncated) {
+        regIndex = this->find_register(UMODBUS_TABLE_HOLDING_REGISTER, address);
+
+        register_t entry;
+        const register_t * reg_i = (regIndex != SIZE_MAX) ? umodbus_get_entry(this->tables + UMODBUS_TABLE_HOLDING_REGISTER, regIndex, entry) : 0;
+
+        if(reg_i != 0 && UMODBUS_GET_STORAGE(reg_i) == UMODBUS_STORAGE_FIFO) {
+            umodbus_fifo_t * fifo = UMODBUS_FIFOOF(reg_i);
+            uint8_t fifoCount = umodbus_fifo_count(fifo);
+            uint8_t * values;
+
+            this->write(fnc);
+            this->write_data((uint16_t)(2 + fifoCount * 2));
+            this->write_data((uint16_t)fifoCount);
+            values = this->reserve(fifoCount * 2);
+
+            // values only leave the queue once they have a place in the response.
+            if(values != 0) {
+                umodbus_fifo_pop_to_wire(fifo, values, fifoCount);
             }
         } else {
             this->write(fnc + 0x80);
@@ -334,15 +778,399 @@ void uModbus::write_multiple_as_register(const uint8_t & fnc) {
         this->write(0x03);
     }
 }
-    
 
-void uModbus::read_write_as_register(const uint8_t & fnc) {
+// one block copy per backing array. single points are blocks of one.
+// index must come from find_range(table, address, count).
+void uModbus::load_registers(const uint8_t & table, const size_t & index, const uint16_t & address, const uint16_t & count, uint8_t * dst) {
+    register_t entry;
+    size_t k = index;
+
+    for(uint16_t i = 0; i < count; k++) {
+        const register_t * reg_i = umodbus_get_entry(this->tables + table, k, entry);
+        uint16_t offset = (i == 0) ? address - reg_i->address : 0;
+        uint16_t n = UMODBUS_GET_COUNT(reg_i) - offset;
+        n = (n < count - i) ? n : (count - i);
+
+        if(n == 0) {
+            this->tx_failed = true;
+            break;
+        }
+
+        if(UMODBUS_GET_STORAGE(reg_i) == UMODBUS_STORAGE_VALUE) {
+            umodbus_value_to_wire(dst + i * 2, reg_i, offset, n);
+        } else if(UMODBUS_GET_STORAGE(reg_i) == UMODBUS_STORAGE_BANK) {
+            umodbus_bank_to_wire(UMODBUS_BANKOF(reg_i), dst + i * 2, offset, n);
+        } else if(UMODBUS_GET_STORAGE(reg_i) == UMODBUS_STORAGE_FIFO) {
+            umodbus_store_u16(dst + i * 2, umodbus_fifo_count(UMODBUS_FIFOOF(reg_i)));
+        } else if(UMODBUS_GET_STORAGE(reg_i) == UMODBUS_STORAGE_CALLBACK) {
+            const umodbus_callbacks_t * callbacks = UMODBUS_CALLBACKSOF(reg_i);
+
+            if(callbacks->read == 0) {
+                memset(dst + i * 2, 0, n * 2);
+            } else if(!callbacks->read(callbacks->context, reg_i->address + offset, dst + i * 2, n)) {
+                this->tx_failed = true;
+            }
+        } else {
+            umodbus_copy_to_wire(dst + i * 2, UMODBUS_VALUEOF(reg_i) + offset, n);
+        }
+        i += n;
+    }
+}
 
+// fifos, banks and callback blocks without a write callback only produce values,
+// writes to them are answered with exception 02 rather than dropped.
+bool uModbus::writable_range(const uint8_t & table, const size_t & index, const uint16_t & address, const uint16_t & count) {
+    register_t entry;
+    uint32_t end = (uint32_t)address + count;
+    size_t k = index;
+
+    for(uint32_t next = address; next < end && k < this->tables[table].size; k++) {
+        const register_t * reg_i = umodbus_get_entry(this->tables + table, k, entry);
+
+        if(UMODBUS_GET_STORAGE(reg_i) == UMODBUS_STORAGE_FIFO || UMODBUS_GET_STORAGE(reg_i) == UMODBUS_STORAGE_BANK
+            || (UMODBUS_GET_STORAGE(reg_i) == UMODBUS_STORAGE_CALLBACK && UMODBUS_CALLBACKSOF(reg_i)->write == 0)) {
+            return false;
+        }
+
+        next = (uint32_t)reg_i->address + UMODBUS_GET_COUNT(reg_i);
+    }
+
+    return true;
+}
+
+void uModbus::store_registers(const uint8_t & table, const size_t & index, const uint16_t & address, const uint16_t & count, const uint8_t * src) {
+    register_t entry;
+    size_t k = index;
+
+    // a read of this request already failed (FC22), do not store what came of it.
+    if(this->tx_failed) {
+        return;
+    }
+
+    for(uint16_t i = 0; i < count; k++) {
+        const register_t * reg_i = umodbus_get_entry(this->tables + table, k, entry);
+        uint16_t offset = (i == 0) ? address - reg_i->address : 0;
+        uint16_t n = UMODBUS_GET_COUNT(reg_i) - offset;
+        n = (n < count - i) ? n : (count - i);
+
+        if(n == 0) {
+            this->tx_failed = true;
+            break;
+        }
+
+        if(UMODBUS_GET_STORAGE(reg_i) == UMODBUS_STORAGE_WORDS) {
+            umodbus_copy_from_wire(UMODBUS_VALUEOF(reg_i) + offset, src + i * 2, n);
+        } else if(UMODBUS_GET_STORAGE(reg_i) == UMODBUS_STORAGE_VALUE) {
+            umodbus_value_from_wire(reg_i, offset, src + i * 2, n);
+        } else if(UMODBUS_GET_STORAGE(reg_i) == UMODBUS_STORAGE_CALLBACK) {
+            const umodbus_callbacks_t * callbacks = UMODBUS_CALLBACKSOF(reg_i);
+
+            if(callbacks->write != 0 && !callbacks->write(callbacks->context, reg_i->address + offset, src + i * 2, n)) {
+                this->tx_failed = true;
+                break;
+            }
+        }
+
+        // segment by segment, so a failed callback leaves the rest unreported. adjacent ones merge.
+        this->mark_written(table, reg_i->address + offset, n);
+        i += n;
+    }
+}
+
+static inline void widen_range(write_range_t * r, const uint32_t & address, const uint32_t & end) {
+    uint32_t r_end = (uint32_t)r->address + r->count;
+
+    r->address = (uint16_t)((address < r->address) ? address : r->address);
+    r->count = (uint16_t)(((end > r_end) ? end : r_end) - r->address);
+}
+
+void uModbus::mark_written(const uint8_t & table, const uint16_t & address, const uint16_t & count) {
+    uint32_t end = (uint32_t)address + count;
+    write_range_t * merge = 0;
+    uint32_t best = UINT32_MAX;
+
+    if(this->write_callback == 0) {
+        return;
+    }
+
+    // grow a range the write touches, or when none does and all are taken, the closest one.
+    for(size_t i = 0; i < this->write_count; i++) {
+        write_range_t * r = this->write_ranges + i;
+        uint32_t r_end = (uint32_t)r->address + r->count;
+        uint32_t gap = (address > r_end) ? (address - r_end) : (r->address > end) ? (r->address - end) : 0;
+
+        if(r->table == table && gap < best) {
+            merge = r;
+            best = gap;
+        }
+    }
+
+    if(merge != 0 && (best == 0 || this->write_count == UMODBUS_WRITE_RANGES)) {
+        size_t m = merge - this->write_ranges;
+
+        widen_range(merge, address, end);
+
+        // the grown range may now reach others of the same table, fold them in.
+        for(size_t i = 0; i < this->write_count;) {
+            write_range_t * r = this->write_ranges + i;
+            merge = this->write_ranges + m;
+
+            if(i != m && r->table == table && r->address <= (uint32_t)merge->address + merge->count 
+                && merge->address <= (uint32_t)r->address + r->count) {
+                widen_range(merge, r->address, (uint32_t)r->address + r->count);
+                this->write_ranges[i] = this->write_ranges[--this->write_count];
+                m = (m == this->write_count) ? i : m;
+            } else {
+                i++;
+            }
+        }
+    } else if(this->write_count < UMODBUS_WRITE_RANGES) {
+        write_range_t * r = this->write_ranges + this->write_count++;
+
+        r->table = table;
+        r->address = address;
+        r->count = count;
+    } else {
+        // every range belongs to the other table. report them now to make room.
+        this->notify_written();
+        this->mark_written(table, address, count);
+    }
+}
+
+void uModbus::notify_written() {
+    if(this->write_callback != 0 && this->write_count > 0) {
+        this->write_callback(this->write_context, this->write_ranges, this->write_count);
+    }
+
+    this->write_count = 0;
+}
+
+#ifdef UMODBUS_STATS
+void uModbus::record_stats(const uint8_t & fnc, const size_t & len, const uint32_t & elapsed) {
+    uint8_t slot = umodbus_stats_slot(fnc);
+    bool exception = this->tx_cursor > 1 && (this->tx_ptr[0] & 0x80) != 0;
+    uint8_t event = 0x40;
+
+    this->stats.requests[slot]++;
+    this->stats.bytes_in += len;
+    this->stats.bytes_out += this->tx_cursor;
+    this->stats.bus_messages++;
+    this->stats.server_messages++;
+    this->stats.handler_time[umodbus_stats_bucket(elapsed)]++;
+
+    if(exception) {
+        uint8_t code = this->tx_ptr[1];
+
+        this->stats.exceptions[slot]++;
+        // send event bits: read exception (01-03), abort (04), busy (05-06), nak (07).
+        event |= (code <= 0x03) ? 0x01 : (code == 0x04) ? 0x02 : (code <= 0x06) ? 0x04 : 0x08;
+    } else if(fnc != UMODBUS_FNCODE_GET_COMM_EV_CNTR && fnc != UMODBUS_FNCODE_GET_COMM_EV_LOG) {
+        this->stats.events++;
+    }
+
+    if(fnc != UMODBUS_FNCODE_GET_COMM_EV_LOG) {
+        this->stats.event_log[this->stats.event_head] = event;
+        this->stats.event_head = (this->stats.event_head + 1) % UMODBUS_STATS_EVENTS;
+        this->stats.event_count += (this->stats.event_count < UMODBUS_STATS_EVENTS) ? 1 : 0;
+    }
+}
+
+void uModbus::diagnostics(const uint8_t & fnc) {
+    uint16_t subFunction;
+    uint16_t data;
+    uint32_t exceptions = 0;
+
+    this->read_data(subFunction);
+
+    if(this->rx_truncated || this->available() < 2) {
+        this->write(fnc + 0x80);
+        this->write(0x03);
+        return;
+    }
+
+    for(uint8_t i = 0; i < UMODBUS_STATS_SLOTS; i++) {
+        exceptions += this->stats.exceptions[i];
+    }
+
+    switch (subFunction)
+    {
+    case UMODBUS_DIAG_RETURN_QUERY_DATA:
+        data = 0;
+        break;
+    case UMODBUS_DIAG_RESTART_COMM:
+    case UMODBUS_DIAG_CLEAR_COUNTERS:
+        this->reset_stats();
+        data = 0;
+        break;
+    case UMODBUS_DIAG_RETURN_REGISTER:
+    case UMODBUS_DIAG_SERVER_NAKS:
+    case UMODBUS_DIAG_SERVER_BUSY:
+    case UMODBUS_DIAG_CHAR_OVERRUNS:
+    case UMODBUS_DIAG_CLEAR_OVERRUNS:
+        data = 0;
+        break;
+    case UMODBUS_DIAG_BUS_MESSAGES:
+        data = (uint16_t)this->stats.bus_messages;
+        break;
+    case UMODBUS_DIAG_BUS_COMM_ERRORS:
+        data = (uint16_t)this->stats.frame_errors;
+        break;
+    case UMODBUS_DIAG_BUS_EXCEPTIONS:
+        data = (uint16_t)exceptions;
+        break;
+    case UMODBUS_DIAG_SERVER_MESSAGES:
+        data = (uint16_t)this->stats.server_messages;
+        break;
+    case UMODBUS_DIAG_SERVER_NO_RESPONSES:
+        data = (uint16_t)this->stats.no_responses;
+        break;
+    default:
+        this->write(fnc + 0x80);
+        this->write(0x01);
+        return;
+    }
+
+    this->write(fnc);
+    this->write_data(subFunction);
+
+    // query data and the clear/restart requests echo what was sent, the counters answer a value.
+    if(subFunction == UMODBUS_DIAG_RETURN_QUERY_DATA || subFunction == UMODBUS_DIAG_RESTART_COMM
+        || subFunction == UMODBUS_DIAG_CLEAR_COUNTERS || subFunction == UMODBUS_DIAG_CLEAR_OVERRUNS) {
+        this->write(this->rx_ptr + this->rx_cursor, this->available());
+        this->rx_cursor = this->rx_size;
+    } else {
+        this->write_data(data);
+    }
+}
+
+void uModbus::get_comm_event_counter(const uint8_t & fnc) {
+    this->write(fnc);
+    this->write_data(0x0000);
+    this->write_data(this->stats.events);
+}
+
+void uModbus::get_comm_event_log(const uint8_t & fnc) {
+    uint8_t * log;
+
+    this->write(fnc);
+    this->write((uint8_t)(6 + this->stats.event_count));
+    this->write_data(0x0000);
+    this->write_data(this->stats.events);
+    this->write_data((uint16_t)this->stats.bus_messages);
+    log = this->reserve(this->stats.event_count);
+
+    // newest event first.
+    for(uint8_t i = 0; log != 0 && i < this->stats.event_count; i++) {
+        log[i] = this->stats.event_log[(this->stats.event_head + UMODBUS_STATS_EVENTS - 1 - i) % UMODBUS_STATS_EVENTS];
+    }
+}
+#endif
+
+bool uModbus::set_device_identification(const device_object_t * objects, const size_t & len, uint8_t * buff, const size_t & size) {
+    const device_object_t * next = 0;
+    size_t used = 0;
+    uint8_t level = UMODBUS_DEV_ID_BASIC;
+    bool ok = len > 0;
+
+    this->device_id = 0;
+    this->device_id_size = 0;
+    this->device_id_level = 0;
+
+    // selection sort by id into buff, lists are short and this runs once.
+    for(size_t n = 0; n < len && ok; n++) {
+        const device_object_t * prev = next;
+        next = 0;
+
+        for(size_t i = 0; i < len; i++) {
+            if((prev == 0 || objects[i].id > prev->id) && (next == 0 || objects[i].id < next->id)) {
+                next = objects + i;
+            }
+        }
+
+        // a repeated id leaves fewer objects than len to pick. a NULL value is an empty object.
+        size_t length = (next == 0) ? 0 : (next->value == 0) ? next->length : (next->length == 0) ? strlen(next->value) : next->length;
+        // one object has to fit a response on its own: 7 bytes of header, 2 of record.
+        ok = next != 0 && (next->value != 0 || length == 0) && (n > 2 || next->id == n) 
+            && length <= UMODBUS_MAX_PDU_SIZE - 9 && size - used >= length + 2;
+
+        if(ok) {
+            buff[used] = next->id;
+            buff[used + 1] = (uint8_t)length;
+
+            if(length > 0) {
+                memcpy(buff + used + 2, next->value, length);
+            }
+
+            used += length + 2;
+            level = (next->id >= 0x80) ? UMODBUS_DEV_ID_EXTENDED : (next->id > UMODBUS_OBJECT_REVISION) ? UMODBUS_DEV_ID_REGULAR : level;
+        }
+    }
+
+    if(ok) {
+        this->device_id = buff;
+        this->device_id_size = used;
+        // individual access is always supported.
+        this->device_id_level = 0x80 | level;
+    }
+
+    return ok;
 }
 
 void uModbus::read_mei_type(const uint8_t & fnc) {
-    this->write(fnc + 0x80);
-    this->write(0x01);
+    uint8_t mei = this->read();
+    uint8_t code = this->read();
+    uint8_t id = this->read();
+
+    if(this->device_id == 0 || mei != UMODBUS_MEI_RD_DEV_ID) {
+        this->write(fnc + 0x80);
+        this->write(0x01);
+    } else if(this->rx_truncated || code < UMODBUS_DEV_ID_BASIC || code > UMODBUS_DEV_ID_SPECIFIC) {
+        this->write(fnc + 0x80);
+        this->write(0x03);
+    } else {
+        const uint8_t * objects = this->device_id;
+        uint8_t limit = (code == UMODBUS_DEV_ID_BASIC) ? UMODBUS_OBJECT_REVISION : (code == UMODBUS_DEV_ID_REGULAR) ? 0x7F : 0xFF;
+        size_t room = ((this->tx_size < UMODBUS_MAX_PDU_SIZE) ? this->tx_size : UMODBUS_MAX_PDU_SIZE);
+        size_t first = 0;
+
+        while(first < this->device_id_size && objects[first] != id) {
+            first += objects[first + 1] + 2;
+        }
+
+        // streams restart at object 0 when asked for one they do not hold.
+        if(code != UMODBUS_DEV_ID_SPECIFIC && (first == this->device_id_size || id > limit)) {
+            first = 0;
+        }
+
+        if(first == this->device_id_size) {
+            this->write(fnc + 0x80);
+            this->write(0x02);
+        } else {
+            // the first object always goes in, reserve() fails when it alone does not fit.
+            size_t last = first + objects[first + 1] + 2;
+            uint8_t count = 1;
+            bool more;
+
+            room = (room > 7) ? room - 7 : 0;
+
+            while(code != UMODBUS_DEV_ID_SPECIFIC && last < this->device_id_size && objects[last] <= limit && 
+                last + objects[last + 1] + 2 - first <= room) {
+                last += objects[last + 1] + 2;
+                count++;
+            }
+
+            more = code != UMODBUS_DEV_ID_SPECIFIC && last < this->device_id_size && objects[last] <= limit;
+
+            this->write(fnc);
+            this->write(mei);
+            this->write(code);
+            this->write(this->device_id_level);
+            this->write(more ? 0xFF : 0x00);
+            this->write(more ? objects[last] : 0x00);
+            this->write(count);
+            this->write(objects + first, last - first);
+        }
+    }
 }
 
 void uModbus::execute_function(const uint8_t & fnc) {
@@ -350,45 +1178,77 @@ void uModbus::execute_function(const uint8_t & fnc) {
     this->write(0x01);
 }
 
-size_t uModbus::binary_search(const uint16_t & address) {
+size_t uModbus::find_register(const uint8_t & table, const uint16_t & address) {
+    register_table_t * t = this->tables + table;
+
+    if(t->dense) {
+        return (address >= t->base && (size_t)(address - t->base) < t->size) ? (size_t)(address - t->base) : SIZE_MAX;
+    } else if(t->index != 0) {
+        uint8_t slot = (address >= t->base && (size_t)(address - t->base) < t->span) ? umodbus_get_slot(t, address - t->base) : UMODBUS_MAP_NONE;
+        return (slot != UMODBUS_MAP_NONE) ? slot : SIZE_MAX;
+    } else {
+        return this->binary_search(t, address);
+    }
+}
+
+size_t uModbus::find_range(const uint8_t & table, const uint16_t & address, const uint16_t & count) {
+    register_table_t * t = this->tables + table;
+    size_t index = this->find_register(table, address);
+    uint32_t end = (uint32_t)address + count;
+
+    if(index == SIZE_MAX || count == 0) {
+        return SIZE_MAX;
+    } else if(t->dense) {
+        return ((index + count) <= t->size) ? index : SIZE_MAX;
+    } else {
+        register_t entry;
+        const register_t * reg_i = umodbus_get_entry(t, index, entry);
+        uint32_t next = (uint32_t)reg_i->address + UMODBUS_GET_COUNT(reg_i);
+
+        // walk the blocks covering the range, rejecting any gap between them.
+        for(size_t i = index + 1; next < end; i++) {
+            if(i >= t->size) {
+                return SIZE_MAX;
+            }
+
+            reg_i = umodbus_get_entry(t, i, entry);
+
+            if(reg_i->address != next) {
+                return SIZE_MAX;
+            }
+
+            next += UMODBUS_GET_COUNT(reg_i);
+        }
+
+        return index;
+    }
+}
+
+size_t uModbus::binary_search(const register_table_t * table, const uint16_t & address) {
+    register_t entry;
     size_t first = 0;
-    size_t last = this->reg_size - 1;
-    size_t middle = (first + last) / 2;
+    size_t last = table->size;
+
+    // find the last entry starting at or below address, then check address falls inside it.
+    while (first < last) {
+        size_t middle = first + (last - first) / 2;
 
-    while (first <= last) {
-        register_t * reg_i = this->reg + middle;
-        if(reg_i->address < address) {
+        if(umodbus_get_entry(table, middle, entry)->address <= address) {
             first = middle + 1;
-        } else if (reg_i->address > address) {
-            last = middle - 1;
-        } else { 
-            return middle;
+        } else {
+            last = middle;
         }
-        
-        middle = (first + last) / 2;
     }
 
-    return SIZE_MAX;
-}
+    if(first > 0) {
+        const register_t * reg_i = umodbus_get_entry(table, first - 1, entry);
 
-void    uModbus::read_data(uint16_t & val) {
-    if(umodbus_get_endianness() == UMODBUS_LITTLE_ENDIAN) {
-        val = this->read();
-        val = (val << 8) + this->read();
-    } else {
-        val = this->read();
-        val = val + (((uint16_t)this->read()) << 8);
+        if((uint32_t)address < (uint32_t)reg_i->address + UMODBUS_GET_COUNT(reg_i)) {
+            return first - 1;
+        }
     }
-}
 
-void    uModbus::write_data(const uint16_t & val) {
-    if(umodbus_get_endianness() == UMODBUS_LITTLE_ENDIAN) {
-        this->write((uint8_t)(val >> 8));
-        this->write((uint8_t)(val & 0x00FF));
-    } else {
-        this->write((uint8_t)(val & 0x00FF));
-        this->write((uint8_t)(val >> 8));
-    }    
+    return SIZE_MAX;
 }
 
 };
\ No newline at end of file
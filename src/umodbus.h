@@ -3,14 +3,20 @@
 
 #include <stddef.h>
 #include <stdint.h>
+#include <string.h>
+
+#include "umodbus_pgm.h"
 
 #define UMODBUS_PTROF(v)                    ((uint8_t *)(&(v))) 
 
 #define UMODBUS_U16_PTROF(v)                ((uint16_t *)(&(v))) 
 #define UMODBUS_U16_NPTROF(v,n)             ((uint16_t *)(&(v)) + (n))
+#define UMODBUS_BITS_PTROF(v)               ((uint16_t *)(v))
 
 #define UMODBUS_TOPDIV(a,b)                 (((a) + (b) - 1) / (b))
 
+#define UMODBUS_MAX_PDU_SIZE                253
+
 #define UMODBUS_SIZE_COIL                   1
 #define UMODBUS_SIZE_REGISTER               2
 
@@ -19,9 +25,41 @@
 #define UMODBUS_TYPE_HOLDING_REGISTER       2
 #define UMODBUS_TYPE_INPUT_REGISTER         6
 
+// how a register_t entry stores its values. the default is one uint16_t per address.
+#define UMODBUS_STORAGE_WORDS               0x00
+#define UMODBUS_STORAGE_BITS                0x08
+#define UMODBUS_STORAGE_FIFO                0x10
+#define UMODBUS_STORAGE_VALUE               0x18
+#define UMODBUS_STORAGE_BANK                0x20
+#define UMODBUS_STORAGE_CALLBACK            0x28
+
+// word order of a UMODBUS_STORAGE_VALUE block. most significant word first by default.
+#define UMODBUS_WORDS_LOW_FIRST             0x40
+
+#define UMODBUS_TYPE_COIL_BITS              (UMODBUS_TYPE_COIL | UMODBUS_STORAGE_BITS)
+#define UMODBUS_TYPE_DISCRETE_INPUT_BITS    (UMODBUS_TYPE_DISCRETE_INPUT | UMODBUS_STORAGE_BITS)
+#define UMODBUS_TYPE_HOLDING_REGISTER_FIFO  (UMODBUS_TYPE_HOLDING_REGISTER | UMODBUS_STORAGE_FIFO)
+#define UMODBUS_TYPE_HOLDING_REGISTER_BANK  (UMODBUS_TYPE_HOLDING_REGISTER | UMODBUS_STORAGE_BANK)
+#define UMODBUS_TYPE_INPUT_REGISTER_BANK    (UMODBUS_TYPE_INPUT_REGISTER | UMODBUS_STORAGE_BANK)
+#define UMODBUS_TYPE_HOLDING_REGISTER_CALLBACK  (UMODBUS_TYPE_HOLDING_REGISTER | UMODBUS_STORAGE_CALLBACK)
+#define UMODBUS_TYPE_INPUT_REGISTER_CALLBACK    (UMODBUS_TYPE_INPUT_REGISTER | UMODBUS_STORAGE_CALLBACK)
+
+#define UMODBUS_TABLE_COIL                  0
+#define UMODBUS_TABLE_DISCRETE_INPUT        1
+#define UMODBUS_TABLE_HOLDING_REGISTER      2
+#define UMODBUS_TABLE_INPUT_REGISTER        3
+#define UMODBUS_TABLE_COUNT                 4
+
 #define UMODBUS_VALUEOF(a)                  ((a)->ptr)
+#define UMODBUS_CALLBACKS_PTROF(v)          ((uint16_t *)(&(v)))
+#define UMODBUS_CALLBACKSOF(a)              ((umodbus::umodbus_callbacks_t *)((a)->ptr))
+#define UMODBUS_BITSOF(a)                   ((uint8_t *)((a)->ptr))
+#define UMODBUS_GET_STORAGE(a)              (((a)->type) & 0x38)
 #define UMODBUS_GET_SIZE(a)                 (((a)->type) & 3)
+#define UMODBUS_IS_LOW_WORD_FIRST(a)        ((((a)->type) & UMODBUS_WORDS_LOW_FIRST) > 0)
 #define UMODBUS_IS_READONLY(a)              ((((a)->type) & 4) > 0)
+#define UMODBUS_GET_COUNT(a)                ((((a)->count) > 1) ? ((a)->count) : 1)
+#define UMODBUS_GET_TABLE(a)                (((UMODBUS_GET_SIZE(a) - 1) << 1) | (UMODBUS_IS_READONLY(a) ? 1 : 0))
 
 #define UMODBUS_COIL_OFF                    0x0000
 #define UMODBUS_COIL_ON                     0xFF00
@@ -50,46 +88,446 @@
 #define UMODBUS_FNCODE_RD_FIFO_QUEUE        0x18
 #define UMODBUS_FNCODE_RD_DEV_ID            0x2B
 
+#define UMODBUS_MEI_RD_DEV_ID               0x0E
+
+// read device id codes, the stream ones read objects up to 0x02, 0x7F and 0xFF.
+#define UMODBUS_DEV_ID_BASIC                0x01
+#define UMODBUS_DEV_ID_REGULAR              0x02
+#define UMODBUS_DEV_ID_EXTENDED             0x03
+#define UMODBUS_DEV_ID_SPECIFIC             0x04
+
+#define UMODBUS_OBJECT_VENDOR_NAME          0x00
+#define UMODBUS_OBJECT_PRODUCT_CODE         0x01
+#define UMODBUS_OBJECT_REVISION             0x02
+#define UMODBUS_OBJECT_VENDOR_URL           0x03
+#define UMODBUS_OBJECT_PRODUCT_NAME         0x04
+#define UMODBUS_OBJECT_MODEL_NAME           0x05
+#define UMODBUS_OBJECT_APPLICATION_NAME     0x06
+
 #define UMODBUS_LITTLE_ENDIAN               1
 #define UMODBUS_BIG_ENDIAN                  2
 
+#ifndef UMODBUS_HOST_ENDIANNESS
+#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+#define UMODBUS_HOST_ENDIANNESS             UMODBUS_BIG_ENDIAN
+#else
+#define UMODBUS_HOST_ENDIANNESS             UMODBUS_LITTLE_ENDIAN
+#endif
+#endif
+
+#if defined(__GNUC__)
+#define UMODBUS_BSWAP16(v)                  __builtin_bswap16(v)
+#else
+#define UMODBUS_BSWAP16(v)                  ((uint16_t)(((v) >> 8) | ((v) << 8)))
+#endif
+
+// byte sized flags and indexes shared with ISRs or other threads.
+#if defined(__GNUC__)
+#define UMODBUS_ATOMIC_LOAD(p)              __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define UMODBUS_ATOMIC_STORE(p,v)           __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define UMODBUS_ACQUIRE_FENCE()             __atomic_thread_fence(__ATOMIC_ACQUIRE)
+#define UMODBUS_RELEASE_FENCE()             __atomic_thread_fence(__ATOMIC_RELEASE)
+#else
+#define UMODBUS_ATOMIC_LOAD(p)              (*(volatile uint8_t *)(p))
+#define UMODBUS_ATOMIC_STORE(p,v)           (*(volatile uint8_t *)(p) = (v))
+#define UMODBUS_ACQUIRE_FENCE()
+#define UMODBUS_RELEASE_FENCE()
+#endif
+
 namespace umodbus {
 
-uint8_t umodbus_get_endianness();
+inline uint8_t umodbus_get_endianness() {
+    return UMODBUS_HOST_ENDIANNESS;
+}
+
+// modbus is big-endian on the wire. shifts let the compiler emit a plain load/store plus bswap.
+inline uint16_t umodbus_load_u16(const uint8_t * src) {
+    return (uint16_t)((((uint16_t)src[0]) << 8) | src[1]);
+}
+
+inline void umodbus_store_u16(uint8_t * dst, const uint16_t & val) {
+    dst[0] = (uint8_t)(val >> 8);
+    dst[1] = (uint8_t)(val & 0x00FF);
+}
+
+void umodbus_copy_to_wire(uint8_t * dst, const uint16_t * src, const size_t & count);
+void umodbus_copy_from_wire(uint16_t * dst, const uint8_t * src, const size_t & count);
+void umodbus_copy_bits(uint8_t * dst, const size_t & dst_bit, const uint8_t * src, const size_t & src_bit, const size_t & count);
 
+// A single point, or when count > 1, a block of count consecutive addresses
+// backed by the uint16_t array at ptr. Coils and discrete inputs with 
+// UMODBUS_STORAGE_BITS are packed instead, bit i of the block being 
+// bit (i % 8) of byte (i / 8), the same order modbus uses on the wire.
+// A holding register with UMODBUS_STORAGE_FIFO points at a umodbus_fifo_t,
+// FC24 drains it and plain reads see its count. Writes to it get exception 02.
+// UMODBUS_STORAGE_VALUE blocks point at one native variable of count words 
+// (float, int32_t, uint64_t...), see umodbus_bind_value().
+// UMODBUS_STORAGE_BANK blocks point at a umodbus_bank_t of count words. Reads
+// within one bank see a single commit of the application, writes get exception 02.
+// UMODBUS_STORAGE_CALLBACK blocks of holding or input registers point at a 
+// umodbus_callbacks_t, their values are computed when a request asks for them.
 typedef struct
 {
     uint16_t address;
     uint8_t type;
     uint16_t * ptr;
+    uint16_t count;
 } register_t;
 
+// Read or write count registers from address on, the part of a callback block
+// one request touches, in a single call. The values are in wire order, two big
+// endian bytes each (umodbus_store_u16(), umodbus_load_u16()). Returning false
+// answers the request with exception 04.
+typedef bool (*register_read_t)(void * context, const uint16_t & address, uint8_t * dst, const uint16_t & count);
+typedef bool (*register_write_t)(void * context, const uint16_t & address, const uint8_t * src, const uint16_t & count);
+
+// Without read the block reads as zeros, without write it is read-only: writes get exception 02.
+typedef struct
+{
+    register_read_t read;
+    register_write_t write;
+    void * context;
+} umodbus_callbacks_t;
+
+// the part [offset, offset + count) of a value block, converted in a single pass.
+void umodbus_value_to_wire(uint8_t * dst, const register_t * reg, const size_t & offset, const size_t & count);
+void umodbus_value_from_wire(const register_t * reg, const size_t & offset, const uint8_t * src, const size_t & count);
+
+// word order policies for umodbus_bind_value().
+struct umodbus_msw_first {
+    static const uint8_t flags = 0;
+};
+
+struct umodbus_lsw_first {
+    static const uint8_t flags = UMODBUS_WORDS_LOW_FIRST;
+};
+
+// Binds a multi-word variable to sizeof(T) / 2 consecutive registers
+// starting at address. It is found with one lookup and encoded straight 
+// from the variable, no matter the host byte order.
+template<typename T, typename Order>
+inline register_t umodbus_bind_value(const uint16_t & address, const uint8_t & type, T & value) {
+    static_assert(sizeof(T) % 2 == 0, "a value must fill whole registers");
+    register_t reg = { address, (uint8_t)(type | UMODBUS_STORAGE_VALUE | Order::flags), (uint16_t *)(&value), (uint16_t)(sizeof(T) / 2) };
+    return reg;
+}
+
+template<typename T>
+inline register_t umodbus_bind_value(const uint16_t & address, const uint8_t & type, T & value) {
+    return umodbus_bind_value<T, umodbus_msw_first>(address, type, value);
+}
+
+// Sorts a register map in place by table (coils, discrete inputs, holding, input) then address.
+void umodbus_sort_registers(register_t * buff, const size_t & len);
+
+#define UMODBUS_MAP_NONE                    0xFF
+
+// One modbus data model (coils, discrete inputs, holding or input registers). 
+// Entries must be sorted by address and must not overlap. When they are single
+// points with contiguous addresses the table is dense and lookups resolve as 
+// base + offset. Maps built by umodbus_map.h may also carry index, the entry 
+// of every address in [base, base + span) or UMODBUS_MAP_NONE. Otherwise a 
+// binary search is used. With progmem set, reg and index point to flash.
+typedef struct
+{
+    const register_t * reg;
+    size_t size;
+    uint16_t base;
+    bool dense;
+    const uint8_t * index;
+    uint16_t span;
+    bool progmem;
+} register_table_t;
+
+// The descriptor at index of a table, copied to entry when it lives in flash.
+inline const register_t * umodbus_get_entry(const register_table_t * table, const size_t & index, register_t & entry) {
+#ifdef UMODBUS_PROGMEM_TABLES
+    if(table->progmem) {
+        UMODBUS_PGM_COPY(&entry, table->reg + index, sizeof(register_t));
+        return &entry;
+    }
+#endif
+    return table->reg + index;
+}
+
+inline uint8_t umodbus_get_slot(const register_table_t * table, const size_t & offset) {
+#ifdef UMODBUS_PROGMEM_TABLES
+    if(table->progmem) {
+        return UMODBUS_PGM_READ_BYTE(table->index + offset);
+    }
+#endif
+    return table->index[offset];
+}
+
+// A register map sorted and split into tables ahead of time, see umodbus_map.h.
+// It lives in flash (UMODBUS_PROGMEM) together with its tables.
+typedef struct
+{
+    const register_t * reg;
+    size_t size;
+    register_table_t tables[UMODBUS_TABLE_COUNT];
+} register_map_t;
+
+// A contiguous byte buffer. For a request it holds the PDU, for a response
+// size is the capacity on the way in and the bytes written on the way out.
+typedef struct
+{
+    uint8_t * ptr;
+    size_t size;
+} frame_t;
+
+#ifdef UMODBUS_STATS
+// one counter per implemented function code (slot = code, 0x2B goes to 0x19), slot 0 for the rest.
+#define UMODBUS_STATS_SLOTS                 0x1A
+#define UMODBUS_STATS_BUCKETS               16
+
+#ifndef UMODBUS_STATS_EVENTS
+#define UMODBUS_STATS_EVENTS                64
+#endif
+
+#define UMODBUS_DIAG_RETURN_QUERY_DATA      0x00
+#define UMODBUS_DIAG_RESTART_COMM           0x01
+#define UMODBUS_DIAG_RETURN_REGISTER        0x02
+#define UMODBUS_DIAG_CLEAR_COUNTERS         0x0A
+#define UMODBUS_DIAG_BUS_MESSAGES           0x0B
+#define UMODBUS_DIAG_BUS_COMM_ERRORS        0x0C
+#define UMODBUS_DIAG_BUS_EXCEPTIONS         0x0D
+#define UMODBUS_DIAG_SERVER_MESSAGES        0x0E
+#define UMODBUS_DIAG_SERVER_NO_RESPONSES    0x0F
+#define UMODBUS_DIAG_SERVER_NAKS            0x10
+#define UMODBUS_DIAG_SERVER_BUSY            0x11
+#define UMODBUS_DIAG_CHAR_OVERRUNS          0x12
+#define UMODBUS_DIAG_CLEAR_OVERRUNS         0x14
+
+// Counters kept by the server when built with UMODBUS_STATS. Times are in
+// microseconds, histogram bucket i counts values in [2^(i-1), 2^i), bucket 0
+// zero and the last one everything above. They also answer FC08, FC0B and FC0C.
+typedef struct
+{
+    uint32_t requests[UMODBUS_STATS_SLOTS];
+    uint32_t exceptions[UMODBUS_STATS_SLOTS];
+    uint32_t bytes_in;
+    uint32_t bytes_out;
+    // frames dropped by the transport: bad crc, bad header or too long.
+    uint32_t frame_errors;
+    // every frame seen on the bus, addressed to this server or not.
+    uint32_t bus_messages;
+    uint32_t server_messages;
+    uint32_t no_responses;
+    // requests answered without exception, FC0B and FC0C excluded.
+    uint16_t events;
+    // send events (FC0C), newest at event_head - 1.
+    uint8_t event_log[UMODBUS_STATS_EVENTS];
+    uint8_t event_head;
+    uint8_t event_count;
+    uint32_t handler_time[UMODBUS_STATS_BUCKETS];
+    uint32_t latency[UMODBUS_STATS_BUCKETS];
+} umodbus_stats_t;
+
+inline uint8_t umodbus_stats_slot(const uint8_t & fnc) {
+    return (fnc <= UMODBUS_FNCODE_RD_FIFO_QUEUE) ? fnc : (fnc == UMODBUS_FNCODE_RD_DEV_ID) ? 0x19 : 0;
+}
+
+inline uint8_t umodbus_stats_bucket(const uint32_t & value) {
+#if defined(__GNUC__)
+    uint8_t bucket = (value == 0) ? 0 : (uint8_t)(sizeof(unsigned long) * 8 - __builtin_clzl((unsigned long)value));
+#else
+    uint8_t bucket = 0;
+    for(uint32_t v = value; v > 0; v >>= 1) {
+        bucket++;
+    }
+#endif
+    return (bucket < UMODBUS_STATS_BUCKETS) ? bucket : (UMODBUS_STATS_BUCKETS - 1);
+}
+#endif
+
+#ifndef UMODBUS_WRITE_RANGES
+#define UMODBUS_WRITE_RANGES                8
+#endif
+
+// Addresses of one table changed by masters.
+typedef struct
+{
+    uint8_t table;
+    uint16_t address;
+    uint16_t count;
+} write_range_t;
+
+// Called once per request, or once per poll() for every request it answered,
+// with the coalesced ranges written in the meantime. When more disjoint 
+// ranges than UMODBUS_WRITE_RANGES are written, the closest ones are merged.
+typedef void (*write_callback_t)(void * context, const write_range_t * ranges, const size_t & count);
+
+// One device identification object. length 0 takes strlen(value), a NULL value is empty.
+typedef struct
+{
+    uint8_t id;
+    const char * value;
+    uint8_t length;
+} device_object_t;
+
 class uModbus {
 private:
     uint8_t unit_id;
-    register_t * reg;
+    const register_t * reg;
     size_t reg_size;
+    register_table_t tables[UMODBUS_TABLE_COUNT];
+
+    const uint8_t * rx_ptr;
+    size_t rx_size;
+    size_t rx_cursor;
+    bool rx_truncated;
+    uint8_t * tx_ptr;
+    size_t tx_size;
+    size_t tx_cursor;
+    bool tx_failed;
+
+    write_callback_t write_callback;
+    void * write_context;
+    write_range_t write_ranges[UMODBUS_WRITE_RANGES];
+    size_t write_count;
+    bool polling;
+
+    // [id, length, value] records sorted by id, see set_device_identification().
+    const uint8_t * device_id;
+    size_t device_id_size;
+    uint8_t device_id_level;
+#ifdef UMODBUS_STATS
+    umodbus_stats_t stats;
+#endif
 public:
     uModbus();
     uModbus(const uint8_t &unit_id, register_t * buff, const size_t & len);
 
     virtual ~uModbus() { }
 
-    register_t * get_registers();
-    void poll(); 
+    uint8_t get_unit_id();
+    const register_t * get_registers();
+    register_table_t * get_table(const uint8_t & table);
+    // false, and an empty table, when buff is not sorted by address or blocks overlap.
+    bool set_table(const uint8_t & table, const register_t * buff, const size_t & len);
+    // installs a map laid out at compile time, nothing is sorted or scanned.
+    void set_map(const register_map_t & map);
+    // uses a register map kept in flash (UMODBUS_PROGMEM), already sorted by 
+    // table then address. false, and no registers, when it is not.
+    bool set_registers_P(const register_t * buff, const size_t & len);
+    void set_write_callback(write_callback_t callback, void * context = 0);
+    // Serializes the objects into buff once, FC43/14 answers are then copied 
+    // out of it. buff must outlive the server. false, and no identification, 
+    // when buff is too small, an id repeats or objects 0x00-0x02 are missing.
+    bool set_device_identification(const device_object_t * objects, const size_t & len, uint8_t * buff, const size_t & size);
+#ifdef UMODBUS_STATS
+    const umodbus_stats_t * get_stats();
+    void reset_stats();
+#endif
+
+    // Decodes one request PDU and writes the response PDU. Returns the response length.
+    size_t process(const uint8_t * request, const size_t & len, uint8_t * response, const size_t & size);
+    virtual void poll(); 
 
 protected:
-    virtual uint8_t read() = 0;
-    virtual size_t  read(uint8_t * buff, const size_t & len) = 0;
-    virtual void    write(const uint8_t & val) = 0;
-    virtual size_t  write(const uint8_t * buff, const size_t & len) = 0;
-    virtual bool    prepare_response() = 0;
-    virtual void    send() = 0;
+    // Transport contract: hand over a complete request PDU and a response buffer to fill.
+    // send() is called after every request, with an empty response when there is no reply.
+    // poll() keeps asking until prepare_response() has no complete request left.
+    virtual bool    prepare_response(frame_t & request, frame_t & response) = 0;
+    virtual void    send(const frame_t & response) = 0;
 
-    void    read_data(uint16_t & val);
-    void    write_data(const uint16_t & val);
+    void    bind(const uint8_t * request, const size_t & len, uint8_t * response, const size_t & size);
 
-    void set_registers(register_t * buff, const size_t & len);
+    size_t  available() {
+        return this->rx_size - this->rx_cursor;
+    }
+
+    uint8_t read() {
+        if(this->rx_cursor < this->rx_size) {
+            return this->rx_ptr[this->rx_cursor++];
+        } else {
+            this->rx_truncated = true;
+            return 0;
+        }
+    }
+
+    size_t  read(uint8_t * buff, const size_t & len) {
+        size_t realLen = (this->available() >= len) ? len : this->available();
+
+        memcpy(buff, this->rx_ptr + this->rx_cursor, realLen);
+        memset(buff + realLen, 0, len - realLen);
+        this->rx_cursor += realLen;
+        this->rx_truncated = this->rx_truncated || (realLen < len);
+
+        return realLen;
+    }
+
+    // room for len bytes in the response, or 0 when it does not fit. An overflowing
+    // response, like a failed register callback, is replaced by exception 04 once 
+    // the handler returns.
+    uint8_t * reserve(const size_t & len) {
+        uint8_t * ptr = 0;
+
+        if((this->tx_size - this->tx_cursor) >= len) {
+            ptr = this->tx_ptr + this->tx_cursor;
+            this->tx_cursor += len;
+        } else {
+            this->tx_failed = true;
+        }
+
+        return ptr;
+    }
+
+    void    write(const uint8_t & val) {
+        uint8_t * ptr = this->reserve(1);
+
+        if(ptr != 0) {
+            *ptr = val;
+        }
+    }
+
+    size_t  write(const uint8_t * buff, const size_t & len) {
+        uint8_t * ptr = this->reserve(len);
+
+        if(ptr != 0) {
+            memcpy(ptr, buff, len);
+        }
+
+        return (ptr != 0) ? len : 0;
+    }
+
+    void    read_data(uint16_t & val) {
+        uint8_t buff[2];
+        this->read(buff, 2);
+        val = umodbus_load_u16(buff);
+    }
+
+    void    write_data(const uint16_t & val) {
+        uint8_t buff[2];
+        umodbus_store_u16(buff, val);
+        this->write(buff, 2);
+    }
+
+    // transports report what never reaches process(). no-ops without UMODBUS_STATS.
+    void    count_frame_error() {
+#ifdef UMODBUS_STATS
+        this->stats.frame_errors++;
+#endif
+    }
+
+    void    count_bus_message() {
+#ifdef UMODBUS_STATS
+        this->stats.bus_messages++;
+#endif
+    }
+
+    void    count_no_response() {
+#ifdef UMODBUS_STATS
+        this->stats.no_responses++;
+#endif
+    }
+
+    bool set_registers(register_t * buff, const size_t & len);
+    void split_tables(const register_t * buff, const size_t & len, const bool & progmem);
+    void layout_table(register_table_t * t, const register_t * buff, const size_t & len, const bool & progmem);
+    void mark_written(const uint8_t & table, const uint16_t & address, const uint16_t & count);
+    void notify_written();
     
     void read_as_byte(const uint8_t & fnc);
     void read_as_register(const uint8_t & fnc);
@@ -101,11 +539,26 @@ protected:
     void write_multiple_as_register(const uint8_t & fnc);
     
     void read_write_as_register(const uint8_t & fnc);
+    void mask_write_as_register(const uint8_t & fnc);
+    void read_fifo_as_register(const uint8_t & fnc);
+
+#ifdef UMODBUS_STATS
+    void diagnostics(const uint8_t & fnc);
+    void get_comm_event_counter(const uint8_t & fnc);
+    void get_comm_event_log(const uint8_t & fnc);
+    void record_stats(const uint8_t & fnc, const size_t & len, const uint32_t & elapsed);
+#endif
 
     virtual void read_mei_type(const uint8_t & fnc);
     virtual void execute_function(const uint8_t & fnc);
 
-    size_t binary_search(const uint16_t & address);
+    void load_registers(const uint8_t & table, const size_t & index, const uint16_t & address, const uint16_t & count, uint8_t * dst);
+    bool writable_range(const uint8_t & table, const size_t & index, const uint16_t & address, const uint16_t & count);
+    void store_registers(const uint8_t & table, const size_t & index, const uint16_t & address, const uint16_t & count, const uint8_t * src);
+
+    size_t find_register(const uint8_t & table, const uint16_t & address);
+    size_t find_range(const uint8_t & table, const uint16_t & address, const uint16_t & count);
+    size_t binary_search(const register_table_t * table, const uint16_t & address);
 };
 
 };
@@ -0,0 +1,50 @@
+#include "umodbus_bank.h"
+
+// the sequence moves twice per commit, odd while the idle buffer is being written.
+// readers of the front buffer of first are affected once the commit after next starts.
+#define UMODBUS_BANK_FRONT(b,s)     ((b)->storage + (((s) >> 1) & 1) * (b)->count)
+#define UMODBUS_BANK_STALE(f,l)     ((uint8_t)((l) - (f)) >= (((f) & 1) ? 2 : 3))
+
+namespace umodbus {
+
+void umodbus_bank_init(umodbus_bank_t * bank, uint16_t * storage, const uint16_t & count) {
+    bank->storage = storage;
+    bank->count = count;
+    memset(storage, 0, count * 2 * sizeof(uint16_t));
+    UMODBUS_ATOMIC_STORE(&bank->sequence, (uint8_t)0);
+}
+
+void umodbus_bank_commit(umodbus_bank_t * bank, const uint16_t * values) {
+    uint8_t sequence = bank->sequence;
+
+    UMODBUS_ATOMIC_STORE(&bank->sequence, (uint8_t)(sequence + 1));
+    UMODBUS_RELEASE_FENCE();
+    memcpy(UMODBUS_BANK_FRONT(bank, sequence + 2), values, bank->count * sizeof(uint16_t));
+    UMODBUS_ATOMIC_STORE(&bank->sequence, (uint8_t)(sequence + 2));
+}
+
+void umodbus_bank_snapshot(umodbus_bank_t * bank, uint16_t * dst, const uint16_t & offset, const uint16_t & count) {
+    uint8_t first;
+    uint8_t last;
+
+    do {
+        first = UMODBUS_ATOMIC_LOAD(&bank->sequence);
+        memcpy(dst, UMODBUS_BANK_FRONT(bank, first) + offset, count * sizeof(uint16_t));
+        UMODBUS_ACQUIRE_FENCE();
+        last = UMODBUS_ATOMIC_LOAD(&bank->sequence);
+    } while(UMODBUS_BANK_STALE(first, last));
+}
+
+void umodbus_bank_to_wire(umodbus_bank_t * bank, uint8_t * dst, const uint16_t & offset, const uint16_t & count) {
+    uint8_t first;
+    uint8_t last;
+
+    do {
+        first = UMODBUS_ATOMIC_LOAD(&bank->sequence);
+        umodbus_copy_to_wire(dst, UMODBUS_BANK_FRONT(bank, first) + offset, count);
+        UMODBUS_ACQUIRE_FENCE();
+        last = UMODBUS_ATOMIC_LOAD(&bank->sequence);
+    } while(UMODBUS_BANK_STALE(first, last));
+}
+
+};
@@ -0,0 +1,36 @@
+#ifndef _UMODBUS_BANK_H_
+#define _UMODBUS_BANK_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "umodbus.h"
+
+#define UMODBUS_BANK_PTROF(v)       ((uint16_t *)(&(v)))
+#define UMODBUS_BANKOF(a)           ((umodbus::umodbus_bank_t *)((a)->ptr))
+
+namespace umodbus {
+
+// Double buffered registers published by a single producer (the loop, a
+// thread or an ISR). A commit fills the idle buffer and then bumps the 
+// sequence, which makes it the one readers see. A reader only repeats its
+// copy when two commits land while it is copying, so it never waits on the
+// producer. storage holds both buffers, 2 * count words.
+typedef struct
+{
+    uint16_t * storage;
+    uint16_t count;
+    uint8_t sequence;
+} umodbus_bank_t;
+
+void umodbus_bank_init(umodbus_bank_t * bank, uint16_t * storage, const uint16_t & count);
+
+// publishes count words, a whole cycle of values, at once.
+void umodbus_bank_commit(umodbus_bank_t * bank, const uint16_t * values);
+
+// a consistent copy of the words [offset, offset + count) of the last commit.
+void umodbus_bank_snapshot(umodbus_bank_t * bank, uint16_t * dst, const uint16_t & offset, const uint16_t & count);
+void umodbus_bank_to_wire(umodbus_bank_t * bank, uint8_t * dst, const uint16_t & offset, const uint16_t & count);
+
+};
+
+#endif
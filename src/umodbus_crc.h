@@ -0,0 +1,17 @@
+#ifndef _UMODBUS_CRC_H_
+#define _UMODBUS_CRC_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define UMODBUS_CRC_INIT            0xFFFF
+
+namespace umodbus {
+
+// Modbus RTU CRC16 (polynomial 0xA001, reflected), one table lookup per byte.
+// Running it over a frame including its trailing CRC yields 0 when the frame is intact.
+uint16_t umodbus_crc16(const uint8_t * buff, const size_t & len, uint16_t crc = UMODBUS_CRC_INIT);
+
+};
+
+#endif
@@ -0,0 +1,47 @@
+#include "umodbus.h"
+#include "umodbus_fifo.h"
+
+namespace umodbus {
+
+void umodbus_fifo_init(umodbus_fifo_t * fifo) {
+    UMODBUS_ATOMIC_STORE(&fifo->head, (uint8_t)0);
+    UMODBUS_ATOMIC_STORE(&fifo->tail, (uint8_t)0);
+}
+
+bool umodbus_fifo_push(umodbus_fifo_t * fifo, const uint16_t & value) {
+    uint8_t head = fifo->head;
+    uint8_t next = (head + 1) % UMODBUS_FIFO_SLOTS;
+
+    if(next == UMODBUS_ATOMIC_LOAD(&fifo->tail)) {
+        return false;
+    }
+
+    fifo->values[head] = value;
+    UMODBUS_ATOMIC_STORE(&fifo->head, next);
+
+    return true;
+}
+
+uint8_t umodbus_fifo_count(umodbus_fifo_t * fifo) {
+    uint8_t head = UMODBUS_ATOMIC_LOAD(&fifo->head);
+    uint8_t tail = UMODBUS_ATOMIC_LOAD(&fifo->tail);
+
+    return (uint8_t)((head + UMODBUS_FIFO_SLOTS - tail) % UMODBUS_FIFO_SLOTS);
+}
+
+uint8_t umodbus_fifo_pop_to_wire(umodbus_fifo_t * fifo, uint8_t * dst, const uint8_t & count) {
+    uint8_t head = UMODBUS_ATOMIC_LOAD(&fifo->head);
+    uint8_t tail = fifo->tail;
+    uint8_t n = 0;
+
+    for(; n < count && tail != head; n++) {
+        umodbus_store_u16(dst + n * 2, fifo->values[tail]);
+        tail = (tail + 1) % UMODBUS_FIFO_SLOTS;
+    }
+
+    UMODBUS_ATOMIC_STORE(&fifo->tail, tail);
+
+    return n;
+}
+
+};
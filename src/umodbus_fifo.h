@@ -0,0 +1,38 @@
+#ifndef _UMODBUS_FIFO_H_
+#define _UMODBUS_FIFO_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "umodbus.h"
+
+// one slot always stays empty, so a queue holds at most 31 values, the FC24 limit.
+#define UMODBUS_FIFO_SLOTS          32
+#define UMODBUS_FIFO_CAPACITY       (UMODBUS_FIFO_SLOTS - 1)
+
+#define UMODBUS_FIFO_PTROF(v)       ((uint16_t *)(&(v)))
+#define UMODBUS_FIFOOF(a)           ((umodbus::umodbus_fifo_t *)((a)->ptr))
+
+namespace umodbus {
+
+// Single producer, single consumer ring of register values. The application
+// pushes (from a thread or an ISR) and the server pops when answering FC24.
+// Indexes are single bytes so loads and stores stay atomic on 8-bit cores.
+typedef struct
+{
+    uint16_t values[UMODBUS_FIFO_SLOTS];
+    uint8_t head;
+    uint8_t tail;
+} umodbus_fifo_t;
+
+void umodbus_fifo_init(umodbus_fifo_t * fifo);
+
+// false when the queue is full, the value is dropped.
+bool umodbus_fifo_push(umodbus_fifo_t * fifo, const uint16_t & value);
+uint8_t umodbus_fifo_count(umodbus_fifo_t * fifo);
+
+// moves up to count values out of the queue into dst, in modbus byte order. Returns how many.
+uint8_t umodbus_fifo_pop_to_wire(umodbus_fifo_t * fifo, uint8_t * dst, const uint8_t & count);
+
+};
+
+#endif
@@ -0,0 +1,292 @@
+#ifndef _U_MODBUS_MAP_H_
+#define _U_MODBUS_MAP_H_
+
+#include "umodbus.h"
+
+#if __cplusplus < 201402L
+#error "umodbus_map.h needs C++14 (-std=gnu++14)"
+#endif
+
+// Tables with an address span up to this many entries get a direct index.
+#ifndef UMODBUS_MAP_INDEX_SPAN
+#define UMODBUS_MAP_INDEX_SPAN              64
+#endif
+
+// One register_t known at compile time. var must be a whole variable with
+// static storage, an array for blocks: its address is a template argument.
+#define UMODBUS_ENTRY(address, type, var, count)    umodbus::umodbus_entry<(address), (type), (count), decltype(var), &var>
+#define UMODBUS_WORDS_ENTRY(address, type, var)     UMODBUS_ENTRY(address, type, var, sizeof(var) / 2)
+#define UMODBUS_VALUE_ENTRY(address, type, var)     UMODBUS_ENTRY(address, (type) | UMODBUS_STORAGE_VALUE, var, sizeof(var) / 2)
+
+namespace umodbus {
+
+template<uint16_t Address, uint8_t Type, uint16_t Count, typename V, V * Ptr>
+struct umodbus_entry {
+    static constexpr uint16_t address = Address;
+    static constexpr uint8_t type = Type;
+    static constexpr uint16_t count = Count;
+    static constexpr V * ptr = Ptr;
+};
+
+typedef struct
+{
+    uint16_t address;
+    uint8_t type;
+    uint16_t count;
+} umodbus_map_key_t;
+
+// Where the entries of a map go, computed by umodbus_plan_map().
+template<size_t N>
+struct umodbus_map_layout_t {
+    // sorted position -> declaration index.
+    size_t order[N];
+    size_t first[UMODBUS_TABLE_COUNT];
+    size_t size[UMODBUS_TABLE_COUNT];
+    uint16_t base[UMODBUS_TABLE_COUNT];
+    bool dense[UMODBUS_TABLE_COUNT];
+    uint16_t span[UMODBUS_TABLE_COUNT];
+    // start of the table in the shared index, or SIZE_MAX without one.
+    size_t index[UMODBUS_TABLE_COUNT];
+    size_t index_size;
+    bool known_types;
+    bool in_range;
+    bool disjoint;
+};
+
+// UMODBUS_GET_TABLE(), UMODBUS_TABLE_COUNT for a type without a table.
+constexpr uint8_t umodbus_map_table(const uint8_t & type) {
+    return ((type & 3) == UMODBUS_SIZE_COIL || (type & 3) == UMODBUS_SIZE_REGISTER) ? 
+        (uint8_t)((((type & 3) - 1) << 1) | ((type & 4) ? 1 : 0)) : UMODBUS_TABLE_COUNT;
+}
+
+constexpr uint32_t umodbus_map_end(const umodbus_map_key_t & key) {
+    return (uint32_t)key.address + ((key.count > 1) ? key.count : 1);
+}
+
+constexpr uint32_t umodbus_map_sort_key(const umodbus_map_key_t & key) {
+    return (((uint32_t)umodbus_map_table(key.type)) << 16) | key.address;
+}
+
+template<size_t N>
+constexpr umodbus_map_layout_t<N> umodbus_plan_map(const umodbus_map_key_t (&keys)[N]) {
+    umodbus_map_layout_t<N> layout = {};
+    size_t position = 0;
+
+    layout.known_types = true;
+    layout.in_range = true;
+    layout.disjoint = true;
+
+    for(size_t i = 0; i < N; i++) {
+        size_t j = i;
+
+        layout.order[i] = i;
+        layout.known_types = layout.known_types && umodbus_map_table(keys[i].type) != UMODBUS_TABLE_COUNT;
+        layout.in_range = layout.in_range && umodbus_map_end(keys[i]) <= 0x10000;
+
+        while(j > 0 && umodbus_map_sort_key(keys[layout.order[j - 1]]) > umodbus_map_sort_key(keys[i])) {
+            layout.order[j] = layout.order[j - 1];
+            j--;
+        }
+        layout.order[j] = i;
+    }
+
+    for(uint8_t t = 0; t < UMODBUS_TABLE_COUNT; t++) {
+        size_t last = position;
+
+        while(last < N && umodbus_map_table(keys[layout.order[last]].type) == t) {
+            last++;
+        }
+
+        layout.first[t] = position;
+        layout.size[t] = last - position;
+        layout.index[t] = SIZE_MAX;
+
+        if(last > position) {
+            const umodbus_map_key_t & head = keys[layout.order[position]];
+            uint32_t span = umodbus_map_end(keys[layout.order[last - 1]]) - head.address;
+
+            layout.base[t] = head.address;
+            layout.dense[t] = span == layout.size[t];
+
+            for(size_t i = position + 1; i < last; i++) {
+                layout.disjoint = layout.disjoint && umodbus_map_end(keys[layout.order[i - 1]]) <= keys[layout.order[i]].address;
+            }
+
+            // with only single points, span == size means no gaps.
+            for(size_t i = position; i < last && layout.dense[t]; i++) {
+                layout.dense[t] = keys[layout.order[i]].count <= 1;
+            }
+
+            if(!layout.dense[t] && span <= UMODBUS_MAP_INDEX_SPAN && layout.size[t] < UMODBUS_MAP_NONE) {
+                layout.span[t] = (uint16_t)span;
+                layout.index[t] = layout.index_size;
+                layout.index_size += span;
+            }
+        }
+
+        position = last;
+    }
+
+    return layout;
+}
+
+// The entry, relative to its table, covering slot k of the shared index.
+template<size_t N>
+constexpr uint8_t umodbus_map_index_at(const umodbus_map_key_t (&keys)[N], const umodbus_map_layout_t<N> & layout, const size_t & k) {
+    for(uint8_t t = 0; t < UMODBUS_TABLE_COUNT; t++) {
+        if(layout.index[t] != SIZE_MAX && k >= layout.index[t] && k < layout.index[t] + layout.span[t]) {
+            uint32_t address = layout.base[t] + (k - layout.index[t]);
+
+            for(size_t i = 0; i < layout.size[t]; i++) {
+                const umodbus_map_key_t & key = keys[layout.order[layout.first[t] + i]];
+
+                if(address >= key.address && address < umodbus_map_end(key)) {
+                    return (uint8_t)i;
+                }
+            }
+        }
+    }
+
+    return UMODBUS_MAP_NONE;
+}
+
+// Keys and layout of a map, planned once per map: everything else only
+// indexes into these constants.
+template<typename... E>
+struct umodbus_map_plan {
+    static constexpr umodbus_map_key_t keys[sizeof...(E)] = { { E::address, E::type, E::count }... };
+    static constexpr umodbus_map_layout_t<sizeof...(E)> layout = umodbus_plan_map(keys);
+};
+
+template<typename... E>
+constexpr umodbus_map_key_t umodbus_map_plan<E...>::keys[sizeof...(E)];
+
+template<typename... E>
+constexpr umodbus_map_layout_t<sizeof...(E)> umodbus_map_plan<E...>::layout;
+
+template<typename... E>
+constexpr const umodbus_map_layout_t<sizeof...(E)> & umodbus_plan_map() {
+    return umodbus_map_plan<E...>::layout;
+}
+
+template<size_t... I>
+struct umodbus_indices { };
+
+template<typename A, typename B>
+struct umodbus_join_indices;
+
+template<size_t... I, size_t... J>
+struct umodbus_join_indices<umodbus_indices<I...>, umodbus_indices<J...> > {
+    typedef umodbus_indices<I..., (sizeof...(I) + J)...> type;
+};
+
+// 0 ... N - 1, halving so large maps stay far from the instantiation depth limit.
+template<size_t N>
+struct umodbus_make_indices : umodbus_join_indices<
+    typename umodbus_make_indices<N / 2>::type, typename umodbus_make_indices<N - N / 2>::type> { };
+
+template<>
+struct umodbus_make_indices<0> {
+    typedef umodbus_indices<> type;
+};
+
+template<>
+struct umodbus_make_indices<1> {
+    typedef umodbus_indices<0> type;
+};
+
+// Entry K of a map by overload resolution against its bases, no recursion per lookup.
+template<size_t K, typename T>
+struct umodbus_map_leaf { };
+
+template<typename Indices, typename... E>
+struct umodbus_map_leaves;
+
+template<size_t... I, typename... E>
+struct umodbus_map_leaves<umodbus_indices<I...>, E...> : umodbus_map_leaf<I, E>... { };
+
+template<size_t K, typename T>
+T umodbus_map_leaf_entry(const umodbus_map_leaf<K, T> *);
+
+template<typename Plan, typename Leaves, typename Order, typename Index>
+struct umodbus_map_storage;
+
+template<typename Plan, typename Leaves, size_t... I, size_t... K>
+struct umodbus_map_storage<Plan, Leaves, umodbus_indices<I...>, umodbus_indices<K...> > {
+    static const register_t registers[sizeof...(I)];
+    // one spare slot, a map without indexed tables still needs an array.
+    static const uint8_t index[sizeof...(K) + 1];
+};
+
+// address constants only, so the compiler emits both arrays as read-only data, in flash on AVR.
+template<typename Plan, typename Leaves, size_t... I, size_t... K>
+const register_t umodbus_map_storage<Plan, Leaves, umodbus_indices<I...>, umodbus_indices<K...> >::registers[sizeof...(I)] UMODBUS_PROGMEM = {
+    {
+        Plan::keys[Plan::layout.order[I]].address,
+        Plan::keys[Plan::layout.order[I]].type,
+        (uint16_t *)(decltype(umodbus_map_leaf_entry<Plan::layout.order[I]>((Leaves *)0))::ptr),
+        Plan::keys[Plan::layout.order[I]].count
+    }...
+};
+
+template<typename Plan, typename Leaves, size_t... I, size_t... K>
+const uint8_t umodbus_map_storage<Plan, Leaves, umodbus_indices<I...>, umodbus_indices<K...> >::index[sizeof...(K) + 1] UMODBUS_PROGMEM = {
+    umodbus_map_index_at(Plan::keys, Plan::layout, K)..., UMODBUS_MAP_NONE
+};
+
+// A register map checked, sorted and laid out by the compiler:
+//
+//   typedef umodbus::umodbus_map<
+//       UMODBUS_WORDS_ENTRY(0, UMODBUS_TYPE_HOLDING_REGISTER, setpoints),
+//       UMODBUS_VALUE_ENTRY(10, UMODBUS_TYPE_INPUT_REGISTER, temperature),
+//       UMODBUS_ENTRY(0, UMODBUS_TYPE_COIL_BITS, relays, 12)> map_t;
+//
+//   server.set_map(map_t::map);
+//
+// Overlapping entries fail to compile. Each table gets the cheapest lookup
+// that fits: base + offset, a direct index or a binary search.
+template<typename... E>
+struct umodbus_map {
+    typedef umodbus_map_plan<E...> plan;
+
+    static_assert(sizeof...(E) > 0, "a register map needs at least one entry");
+    static_assert(plan::layout.known_types, "register map entry with an unknown type");
+    static_assert(plan::layout.in_range, "register map entry runs past address 0xFFFF");
+    static_assert(plan::layout.disjoint, "register map entries overlap");
+
+    typedef umodbus_map_storage<
+        plan,
+        umodbus_map_leaves<typename umodbus_make_indices<sizeof...(E)>::type, E...>,
+        typename umodbus_make_indices<sizeof...(E)>::type,
+        typename umodbus_make_indices<plan::layout.index_size>::type> storage;
+
+    static const register_map_t map;
+};
+
+#define UMODBUS_MAP_TABLE(t) { \
+        storage::registers + plan::layout.first[t], \
+        plan::layout.size[t], \
+        plan::layout.base[t], \
+        plan::layout.dense[t], \
+        (plan::layout.index[t] != SIZE_MAX) ? storage::index + plan::layout.index[t] : 0, \
+        plan::layout.span[t], \
+        true \
+    }
+
+template<typename... E>
+const register_map_t umodbus_map<E...>::map UMODBUS_PROGMEM = {
+    storage::registers,
+    sizeof...(E),
+    {
+        UMODBUS_MAP_TABLE(UMODBUS_TABLE_COIL),
+        UMODBUS_MAP_TABLE(UMODBUS_TABLE_DISCRETE_INPUT),
+        UMODBUS_MAP_TABLE(UMODBUS_TABLE_HOLDING_REGISTER),
+        UMODBUS_MAP_TABLE(UMODBUS_TABLE_INPUT_REGISTER)
+    }
+};
+
+#undef UMODBUS_MAP_TABLE
+
+};
+
+#endif
@@ -0,0 +1,136 @@
+#include "umodbus_master.h"
+
+namespace umodbus {
+
+uModbusMaster::uModbusMaster(register_t * buff, const size_t & len, read_request_t * requests, const size_t & capacity, 
+    const uint16_t & max_gap) {
+    this->reg = buff;
+    this->reg_size = len;
+    this->requests = requests;
+    this->request_capacity = capacity;
+    this->request_count = 0;
+    this->max_gap = max_gap;
+
+    umodbus_sort_registers(buff, len);
+    this->plan();
+}
+
+register_t * uModbusMaster::get_registers() {
+    return this->reg;
+}
+
+read_request_t * uModbusMaster::get_requests() {
+    return this->requests;
+}
+
+size_t uModbusMaster::get_request_count() {
+    return this->request_count;
+}
+
+bool uModbusMaster::plan() {
+    read_request_t * req = 0;
+    uint32_t end = 0;
+
+    this->request_count = 0;
+
+    // greedy, extending the open request while the next point fits. with a 
+    // length limit and a gap limit this yields the fewest requests.
+    for(size_t i = 0; i < this->reg_size; i++) {
+        register_t * reg_i = this->reg + i;
+        uint8_t fnc = UMODBUS_GET_TABLE(reg_i) + 1;
+        uint32_t limit = (fnc <= UMODBUS_FNCODE_RD_M_DISCRETE_INPUT) ? UMODBUS_MASTER_MAX_COILS : UMODBUS_MASTER_MAX_REGISTERS;
+        uint32_t start = reg_i->address;
+        uint32_t stop = start + UMODBUS_GET_COUNT(reg_i);
+
+        // a point nested in the open request must not shrink it.
+        uint32_t merged = (stop > end) ? stop : end;
+
+        if(req != 0 && req->fnc == fnc && start >= req->address && start <= end + this->max_gap && (merged - req->address) <= limit) {
+            req->count = (uint16_t)(merged - req->address);
+            req->last = i;
+            end = merged;
+            continue;
+        }
+
+        for(; start < stop; start += limit) {
+            if(this->request_count == this->request_capacity) {
+                return false;
+            }
+
+            req = this->requests + this->request_count++;
+            req->fnc = fnc;
+            req->address = (uint16_t)start;
+            req->count = (uint16_t)(((stop - start) < limit) ? (stop - start) : limit);
+            req->first = i;
+            req->last = i;
+            req->status = UMODBUS_REQUEST_IDLE;
+        }
+
+        end = stop;
+    }
+
+    return true;
+}
+
+size_t uModbusMaster::encode_request(const size_t & index, uint8_t * pdu, const size_t & size) {
+    read_request_t * req = this->requests + index;
+
+    if(index >= this->request_count || size < 5) {
+        return 0;
+    }
+
+    pdu[0] = req->fnc;
+    umodbus_store_u16(pdu + 1, req->address);
+    umodbus_store_u16(pdu + 3, req->count);
+
+    return 5;
+}
+
+bool uModbusMaster::decode_response(const size_t & index, const uint8_t * pdu, const size_t & len) {
+    read_request_t * req = this->requests + index;
+    const uint8_t * data = pdu + 2;
+    size_t byteCount;
+    bool bits;
+
+    if(index >= this->request_count || len < 2 || pdu[0] != req->fnc) {
+        return false;
+    }
+
+    bits = req->fnc <= UMODBUS_FNCODE_RD_M_DISCRETE_INPUT;
+    byteCount = bits ? UMODBUS_TOPDIV(req->count, 8) : req->count * 2;
+
+    if(pdu[1] != byteCount || len < byteCount + 2) {
+        return false;
+    }
+
+    // scatter the answer back into every point the request covers.
+    for(size_t i = req->first; i <= req->last; i++) {
+        register_t * reg_i = this->reg + i;
+        uint32_t start = (reg_i->address > req->address) ? reg_i->address : req->address;
+        uint32_t stop = (uint32_t)reg_i->address + UMODBUS_GET_COUNT(reg_i);
+        uint16_t offset = (uint16_t)(start - reg_i->address);
+        uint16_t at = (uint16_t)(start - req->address);
+        uint16_t n;
+
+        stop = (stop < (uint32_t)req->address + req->count) ? stop : (uint32_t)req->address + req->count;
+        n = (uint16_t)(stop - start);
+
+        if(bits && UMODBUS_GET_STORAGE(reg_i) == UMODBUS_STORAGE_BITS) {
+            umodbus_copy_bits(UMODBUS_BITSOF(reg_i), offset, data, at, n);
+        } else if(bits && UMODBUS_GET_STORAGE(reg_i) == UMODBUS_STORAGE_WORDS) {
+            uint16_t * value = UMODBUS_VALUEOF(reg_i) + offset;
+
+            for(uint16_t j = 0; j < n; j++, at++) {
+                value[j] = ((data[at / 8] >> (at % 8)) & 1) ? UMODBUS_COIL_ON : UMODBUS_COIL_OFF;
+            }
+        } else if(UMODBUS_GET_STORAGE(reg_i) == UMODBUS_STORAGE_WORDS) {
+            umodbus_copy_from_wire(UMODBUS_VALUEOF(reg_i) + offset, data + at * 2, n);
+        } else if(UMODBUS_GET_STORAGE(reg_i) == UMODBUS_STORAGE_VALUE) {
+            umodbus_value_from_wire(reg_i, offset, data + at * 2, n);
+        }
+    }
+
+    return true;
+}
+
+};
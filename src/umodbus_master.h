@@ -0,0 +1,65 @@
+#ifndef _UMODBUS_MASTER_H_
+#define _UMODBUS_MASTER_H_
+
+#include "umodbus.h"
+
+#define UMODBUS_MASTER_MAX_COILS        0x07D0
+#define UMODBUS_MASTER_MAX_REGISTERS    0x007D
+
+// unmapped addresses read to join two points into one request. Use 0 with
+// devices that answer exception 02 for addresses they do not implement.
+#ifndef UMODBUS_MASTER_MAX_GAP
+#define UMODBUS_MASTER_MAX_GAP          8
+#endif
+
+#define UMODBUS_REQUEST_IDLE            0
+#define UMODBUS_REQUEST_PENDING         1
+#define UMODBUS_REQUEST_DONE            2
+#define UMODBUS_REQUEST_FAILED          3
+
+namespace umodbus {
+
+// One FC01-04 read covering the points first..last of the sorted map.
+// A block longer than a single request allows spans several of them.
+typedef struct
+{
+    uint8_t fnc;
+    uint16_t address;
+    uint16_t count;
+    size_t first;
+    size_t last;
+    uint8_t status;
+} read_request_t;
+
+// Reads a remote register map. The points use the same register_t model as
+// the server: the type picks the function code and ptr receives the values.
+// plan() merges them into as few requests as the modbus limits allow, the
+// transport sends encode_request() and hands the answer to decode_response().
+class uModbusMaster {
+private:
+    register_t * reg;
+    size_t reg_size;
+    read_request_t * requests;
+    size_t request_capacity;
+    size_t request_count;
+    uint16_t max_gap;
+public:
+    uModbusMaster(register_t * buff, const size_t & len, read_request_t * requests, const size_t & capacity, 
+        const uint16_t & max_gap = UMODBUS_MASTER_MAX_GAP);
+    virtual ~uModbusMaster() { }
+
+    register_t * get_registers();
+    read_request_t * get_requests();
+    size_t get_request_count();
+
+    // false when the requests array is too small for the map.
+    bool plan();
+
+    size_t encode_request(const size_t & index, uint8_t * pdu, const size_t & size);
+    // false on an exception response or one that does not match the request.
+    bool decode_response(const size_t & index, const uint8_t * pdu, const size_t & len);
+};
+
+};
+
+#endif
@@ -0,0 +1,38 @@
+#include "umodbus_mbap.h"
+
+namespace umodbus {
+
+size_t mbap_frame_size(const uint8_t * buff, const size_t & len) {
+    uint16_t protocol_id;
+    uint16_t length;
+
+    if(len < UMODBUS_MBAP_SIZE) {
+        return UMODBUS_MBAP_INCOMPLETE;
+    }
+
+    protocol_id = umodbus_load_u16(buff + 2);
+    length = umodbus_load_u16(buff + 4);
+
+    // length counts the unit id plus a pdu of at least the function code.
+    if(protocol_id != 0 || length < 2 || length > UMODBUS_MBAP_MAX_LENGTH) {
+        return UMODBUS_MBAP_INVALID;
+    }
+
+    return (len >= (size_t)(length + UMODBUS_MBAP_SIZE - 1)) ? (length + UMODBUS_MBAP_SIZE - 1) : UMODBUS_MBAP_INCOMPLETE;
+}
+
+void mbap_read_header(const uint8_t * buff, mbap_header_t & header) {
+    header.transaction_identifier = umodbus_load_u16(buff);
+    header.protocol_id = umodbus_load_u16(buff + 2);
+    header.length = umodbus_load_u16(buff + 4);
+    header.unit_id = buff[6];
+}
+
+void mbap_write_header(uint8_t * buff, const mbap_header_t & header) {
+    umodbus_store_u16(buff, header.transaction_identifier);
+    umodbus_store_u16(buff + 2, header.protocol_id);
+    umodbus_store_u16(buff + 4, header.length);
+    buff[6] = header.unit_id;
+}
+
+};
@@ -0,0 +1,32 @@
+#ifndef _UMODBUS_MBAP_H_
+#define _UMODBUS_MBAP_H_
+
+#include "umodbus.h"
+
+#define UMODBUS_MBAP_SIZE               7
+#define UMODBUS_MBAP_MAX_LENGTH         (UMODBUS_MAX_PDU_SIZE + 1)
+#define UMODBUS_MBAP_MAX_FRAME_SIZE     (UMODBUS_MBAP_SIZE - 1 + UMODBUS_MBAP_MAX_LENGTH)
+
+#define UMODBUS_MBAP_INCOMPLETE         0
+#define UMODBUS_MBAP_INVALID            SIZE_MAX
+
+namespace umodbus {
+
+typedef struct __attribute__ ((__packed__)) {
+    uint16_t transaction_identifier;
+    uint16_t protocol_id;
+    uint16_t length;
+    uint8_t unit_id;
+} mbap_header_t;
+
+// Size of the MBAP frame at the start of buff once all of it has arrived, 
+// UMODBUS_MBAP_INCOMPLETE while more bytes are needed or UMODBUS_MBAP_INVALID
+// when the header can not belong to a modbus frame.
+size_t mbap_frame_size(const uint8_t * buff, const size_t & len);
+
+void mbap_read_header(const uint8_t * buff, mbap_header_t & header);
+void mbap_write_header(uint8_t * buff, const mbap_header_t & header);
+
+};
+
+#endif
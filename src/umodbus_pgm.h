@@ -0,0 +1,28 @@
+#ifndef _UMODBUS_PGM_H_
+#define _UMODBUS_PGM_H_
+
+#include <stdint.h>
+#include <string.h>
+
+// Read-only data that can stay in flash. On AVR, flash has its own address
+// space and is read with pgm_read_*, everywhere else it is mapped memory and
+// the accessors are plain loads.
+#if defined(__AVR__)
+#include <avr/pgmspace.h>
+#define UMODBUS_PROGMEM                     PROGMEM
+#define UMODBUS_PGM_READ_BYTE(p)            pgm_read_byte(p)
+#define UMODBUS_PGM_READ_WORD(p)            pgm_read_word(p)
+#define UMODBUS_PGM_COPY(dst, src, len)     memcpy_P((dst), (src), (len))
+
+// register tables may live in flash, their descriptors go through the accessors.
+#ifndef UMODBUS_PROGMEM_TABLES
+#define UMODBUS_PROGMEM_TABLES
+#endif
+#else
+#define UMODBUS_PROGMEM
+#define UMODBUS_PGM_READ_BYTE(p)            (*(const uint8_t *)(p))
+#define UMODBUS_PGM_READ_WORD(p)            (*(const uint16_t *)(p))
+#define UMODBUS_PGM_COPY(dst, src, len)     memcpy((dst), (src), (len))
+#endif
+
+#endif
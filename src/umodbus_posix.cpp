@@ -0,0 +1,309 @@
+#if defined(__linux__)
+
+#include "umodbus_posix.h"
+
+#include <errno.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+
+namespace umodbus {
+
+uModbusPosixServer::uModbusPosixServer(const uint8_t& unit_id, register_t * buff, const size_t & len) : uModbus(unit_id, buff, len) {
+    this->listen_fd = -1;
+    this->epoll_fd = -1;
+    this->connection_list = 0;
+    this->current = 0;
+    this->connection_count = 0;
+    this->frame_size = 0;
+}
+
+uModbusPosixServer::~uModbusPosixServer() {
+    this->close();
+}
+
+bool    uModbusPosixServer::listen(const uint16_t & port, const char * address, const int & backlog) {
+    struct sockaddr_in addr;
+    struct epoll_event event;
+    int enable = 1;
+
+    this->close();
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+
+    if(inet_pton(AF_INET, address, &addr.sin_addr) != 1) {
+        return false;
+    }
+
+    this->listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    this->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+
+    if(this->listen_fd < 0 || this->epoll_fd < 0
+        || setsockopt(this->listen_fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable)) < 0
+        || ::bind(this->listen_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0
+        || ::listen(this->listen_fd, backlog) < 0) {
+        this->close();
+        return false;
+    }
+
+    // the listening socket is the only one registered without a connection.
+    event.events = EPOLLIN;
+    event.data.ptr = 0;
+
+    if(epoll_ctl(this->epoll_fd, EPOLL_CTL_ADD, this->listen_fd, &event) < 0) {
+        this->close();
+        return false;
+    }
+
+    return true;
+}
+
+uint16_t uModbusPosixServer::get_port() {
+    struct sockaddr_in addr;
+    socklen_t len = sizeof(addr);
+
+    if(this->listen_fd < 0 || getsockname(this->listen_fd, (struct sockaddr *)&addr, &len) < 0) {
+        return 0;
+    }
+
+    return ntohs(addr.sin_port);
+}
+
+size_t  uModbusPosixServer::connections() {
+    return this->connection_count;
+}
+
+void    uModbusPosixServer::close() {
+    while(this->connection_list != 0) {
+        this->release(this->connection_list);
+    }
+
+    if(this->listen_fd >= 0) {
+        ::close(this->listen_fd);
+        this->listen_fd = -1;
+    }
+
+    if(this->epoll_fd >= 0) {
+        ::close(this->epoll_fd);
+        this->epoll_fd = -1;
+    }
+}
+
+void    uModbusPosixServer::poll() {
+    this->poll(0);
+}
+
+void    uModbusPosixServer::poll(const int & timeout) {
+    struct epoll_event events[UMODBUS_POSIX_MAX_EVENTS];
+    int count;
+
+    if(this->epoll_fd < 0) {
+        return;
+    }
+
+    count = epoll_wait(this->epoll_fd, events, UMODBUS_POSIX_MAX_EVENTS, timeout);
+
+    for(int i = 0; i < count; i++) {
+        posix_connection_t * conn = (posix_connection_t *) events[i].data.ptr;
+
+        if(conn == 0) {
+            this->accept_all();
+        } else if((events[i].events & (EPOLLERR | EPOLLHUP)) != 0) {
+            this->release(conn);
+        } else if((events[i].events & EPOLLOUT) != 0) {
+            if(!this->flush(conn)) {
+                this->release(conn);
+            } else if(conn->output_length == 0) {
+                this->service(conn);
+            }
+        } else if((events[i].events & EPOLLIN) != 0) {
+            if(!this->receive(conn)) {
+                this->release(conn);
+            } else {
+                this->service(conn);
+            }
+        }
+    }
+}
+
+void    uModbusPosixServer::accept_all() {
+    int fd;
+
+    while((fd = accept4(this->listen_fd, 0, 0, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+        posix_connection_t * conn = new posix_connection_t;
+        struct epoll_event event;
+        int enable = 1;
+
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+
+        conn->fd = fd;
+        conn->events = EPOLLIN;
+        conn->input_length = 0;
+        conn->output_length = 0;
+        conn->output_sent = 0;
+        conn->prev = 0;
+        conn->next = this->connection_list;
+
+        event.events = conn->events;
+        event.data.ptr = conn;
+
+        if(epoll_ctl(this->epoll_fd, EPOLL_CTL_ADD, fd, &event) < 0) {
+            ::close(fd);
+            delete conn;
+            continue;
+        }
+
+        if(this->connection_list != 0) {
+            this->connection_list->prev = conn;
+        }
+
+        this->connection_list = conn;
+        this->connection_count++;
+    }
+}
+
+void    uModbusPosixServer::service(posix_connection_t * conn) {
+    this->current = conn;
+
+    // answer every complete frame, flushing whenever the output buffer fills up.
+    while(true) {
+        uModbus::poll();
+
+        if(this->current == 0) {
+            return;
+        } else if(!this->flush(conn)) {
+            this->release(conn);
+            return;
+        } else if(conn->output_length > 0) {
+            // the peer is not reading. stop taking requests until the backlog drains.
+            this->watch(conn, EPOLLOUT);
+            return;
+        }
+
+        // a bad header goes back to poll(), prepare_response() drops the connection.
+        if(mbap_frame_size(conn->input_buffer, conn->input_length) == UMODBUS_MBAP_INCOMPLETE) {
+            break;
+        }
+    }
+
+    this->watch(conn, EPOLLIN);
+}
+
+bool    uModbusPosixServer::receive(posix_connection_t * conn) {
+    size_t space = UMODBUS_POSIX_INPUT_SIZE - conn->input_length;
+    ssize_t size;
+
+    if(space == 0) {
+        return true;
+    }
+
+    size = ::recv(conn->fd, conn->input_buffer + conn->input_length, space, 0);
+
+    if(size > 0) {
+        conn->input_length += (size_t)size;
+        return true;
+    }
+
+    // 0 means the peer closed the connection.
+    return size < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR);
+}
+
+bool    uModbusPosixServer::flush(posix_connection_t * conn) {
+    while(conn->output_sent < conn->output_length) {
+        ssize_t size = ::send(conn->fd, conn->output_buffer + conn->output_sent, 
+            conn->output_length - conn->output_sent, MSG_NOSIGNAL);
+
+        if(size > 0) {
+            conn->output_sent += (size_t)size;
+        } else if(size < 0 && errno == EINTR) {
+            continue;
+        } else {
+            return size < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+        }
+    }
+
+    conn->output_length = 0;
+    conn->output_sent = 0;
+    return true;
+}
+
+void    uModbusPosixServer::watch(posix_connection_t * conn, const uint32_t & events) {
+    struct epoll_event event;
+
+    if(conn->events != events) {
+        conn->events = events;
+        event.events = events;
+        event.data.ptr = conn;
+        epoll_ctl(this->epoll_fd, EPOLL_CTL_MOD, conn->fd, &event);
+    }
+}
+
+void    uModbusPosixServer::release(posix_connection_t * conn) {
+    if(conn->prev != 0) {
+        conn->prev->next = conn->next;
+    } else {
+        this->connection_list = conn->next;
+    }
+
+    if(conn->next != 0) {
+        conn->next->prev = conn->prev;
+    }
+
+    if(this->current == conn) {
+        this->current = 0;
+    }
+
+    // closing the descriptor also removes it from the epoll set.
+    ::close(conn->fd);
+    delete conn;
+    this->connection_count--;
+}
+
+bool    uModbusPosixServer::prepare_response(frame_t & request, frame_t & response) {
+    posix_connection_t * conn = this->current;
+
+    if(conn == 0 || (UMODBUS_POSIX_OUTPUT_SIZE - conn->output_length) < UMODBUS_MBAP_MAX_FRAME_SIZE) {
+        return false;
+    }
+
+    this->frame_size = mbap_frame_size(conn->input_buffer, conn->input_length);
+
+    if(this->frame_size == UMODBUS_MBAP_INVALID) {
+        // a stream can not resynchronise after a bad header.
+        this->count_frame_error();
+        this->release(conn);
+        return false;
+    } else if(this->frame_size == UMODBUS_MBAP_INCOMPLETE) {
+        return false;
+    }
+
+    memcpy(conn->output_buffer + conn->output_length, conn->input_buffer, UMODBUS_MBAP_SIZE);
+
+    request.ptr = conn->input_buffer + UMODBUS_MBAP_SIZE;
+    request.size = this->frame_size - UMODBUS_MBAP_SIZE;
+    response.ptr = conn->output_buffer + conn->output_length + UMODBUS_MBAP_SIZE;
+    response.size = UMODBUS_MBAP_MAX_FRAME_SIZE - UMODBUS_MBAP_SIZE;
+
+    return true;
+}
+
+void    uModbusPosixServer::send(const frame_t & response) {
+    posix_connection_t * conn = this->current;
+
+    if(response.size > 0) {
+        umodbus_store_u16(conn->output_buffer + conn->output_length + 4, (uint16_t)(response.size + 1));
+        conn->output_length += UMODBUS_MBAP_SIZE + response.size;
+    }
+
+    conn->input_length -= this->frame_size;
+    memmove(conn->input_buffer, conn->input_buffer + this->frame_size, conn->input_length);
+    this->frame_size = 0;
+}
+
+};
+
+#endif
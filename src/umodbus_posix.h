@@ -0,0 +1,72 @@
+#ifndef _UMODBUS_POSIX_H_
+#define _UMODBUS_POSIX_H_
+
+#if defined(__linux__)
+
+#include "umodbus.h"
+#include "umodbus_mbap.h"
+
+#ifndef UMODBUS_POSIX_INPUT_SIZE
+#define UMODBUS_POSIX_INPUT_SIZE        (4 * UMODBUS_MBAP_MAX_FRAME_SIZE)
+#endif
+
+#ifndef UMODBUS_POSIX_OUTPUT_SIZE
+#define UMODBUS_POSIX_OUTPUT_SIZE       (16 * UMODBUS_MBAP_MAX_FRAME_SIZE)
+#endif
+
+#ifndef UMODBUS_POSIX_MAX_EVENTS
+#define UMODBUS_POSIX_MAX_EVENTS        64
+#endif
+
+namespace umodbus {
+
+typedef struct posix_connection {
+    int fd;
+    uint32_t events;
+    uint8_t input_buffer[UMODBUS_POSIX_INPUT_SIZE];
+    size_t input_length;
+    uint8_t output_buffer[UMODBUS_POSIX_OUTPUT_SIZE];
+    size_t output_length;
+    size_t output_sent;
+    struct posix_connection * prev;
+    struct posix_connection * next;
+} posix_connection_t;
+
+// Modbus TCP server over non-blocking sockets and epoll, for Linux gateways, 
+// simulators and load tests. One thread serves every connection from poll().
+class uModbusPosixServer: public uModbus
+{
+private:
+    int listen_fd;
+    int epoll_fd;
+    posix_connection_t * connection_list;
+    posix_connection_t * current;
+    size_t connection_count;
+    size_t frame_size;
+public:
+    uModbusPosixServer(const uint8_t& unit_id, register_t * buff, const size_t & len);
+    virtual ~uModbusPosixServer();
+
+    bool listen(const uint16_t & port, const char * address = "0.0.0.0", const int & backlog = 128);
+    uint16_t get_port();
+    size_t connections();
+    void close();
+
+    virtual void poll();
+    void poll(const int & timeout);
+protected:
+    void            accept_all();
+    void            service(posix_connection_t * conn);
+    bool            receive(posix_connection_t * conn);
+    bool            flush(posix_connection_t * conn);
+    void            watch(posix_connection_t * conn, const uint32_t & events);
+    void            release(posix_connection_t * conn);
+    virtual bool    prepare_response(frame_t & request, frame_t & response);
+    virtual void    send(const frame_t & response);
+};
+
+};
+
+#endif
+
+#endif
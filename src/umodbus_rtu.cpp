@@ -0,0 +1,100 @@
+#include "umodbus_rtu.h"
+#include <Arduino.h>
+
+namespace umodbus {
+
+uModbusRtu::uModbusRtu(const uint8_t& unit_id, register_t * buff, const size_t & len) : uModbus(unit_id, buff, len) {
+    this->serial = 0;
+    this->t35 = 0;
+    this->last_byte = 0;
+    this->input_length = 0;
+    this->overflow = false;
+    this->broadcast = false;
+}
+
+uModbusRtu::~uModbusRtu() { }
+
+void    uModbusRtu::begin(Stream * serial, const uint32_t & baud) {
+    this->serial = serial;
+    this->input_length = 0;
+    this->overflow = false;
+    // 11 bits per character. above 19200 baud the spec fixes t3.5 at 1750us.
+    this->t35 = (baud > 19200) ? 1750 : (uint32_t)(38500000UL / baud);
+}
+
+uint32_t uModbusRtu::get_frame_timeout() {
+    return this->t35;
+}
+
+size_t  uModbusRtu::receive() {
+    size_t size = 0;
+    int val;
+
+    while(this->serial->available() > 0 && (val = this->serial->read()) >= 0) {
+        if(this->input_length < UMODBUS_RTU_BUFFER_SIZE) {
+            this->input_buffer[this->input_length++] = (uint8_t)val;
+        } else {
+            this->overflow = true;
+        }
+        size++;
+    }
+
+    return size;
+}
+
+bool    uModbusRtu::prepare_response(frame_t & request, frame_t & response) {
+    size_t length;
+    bool overflow;
+
+    if(this->serial == 0) {
+        return false;
+    }
+
+    if(this->receive() > 0) {
+        this->last_byte = micros();
+        return false;
+    } else if(this->input_length == 0 || (uint32_t)(micros() - this->last_byte) < this->t35) {
+        return false;
+    }
+
+    // the line has been silent for t3.5, so the buffer holds one whole frame.
+    length = this->input_length;
+    overflow = this->overflow;
+    this->input_length = 0;
+    this->overflow = false;
+
+    if(overflow || length < UMODBUS_RTU_MIN_FRAME_SIZE || umodbus_crc16(this->input_buffer, length) != 0) {
+        this->count_frame_error();
+        return false;
+    } else if(this->input_buffer[0] != this->get_unit_id() && this->input_buffer[0] != UMODBUS_RTU_BROADCAST) {
+        this->count_bus_message();
+        return false;
+    }
+
+    this->broadcast = this->input_buffer[0] == UMODBUS_RTU_BROADCAST;
+
+    request.ptr = this->input_buffer + 1;
+    request.size = length - 3;
+    response.ptr = this->output_buffer + 1;
+    response.size = UMODBUS_RTU_BUFFER_SIZE - 3;
+
+    return true;
+}
+
+void    uModbusRtu::send(const frame_t & response) {
+    uint16_t crc;
+
+    // broadcast requests are executed but never answered.
+    if(response.size > 0 && !this->broadcast) {
+        this->output_buffer[0] = this->get_unit_id();
+        crc = umodbus_crc16(this->output_buffer, response.size + 1);
+        this->output_buffer[response.size + 1] = (uint8_t)(crc & 0x00FF);
+        this->output_buffer[response.size + 2] = (uint8_t)(crc >> 8);
+
+        this->serial->write(this->output_buffer, response.size + 3);
+    } else {
+        this->count_no_response();
+    }
+}
+
+};
@@ -0,0 +1,45 @@
+#ifndef _UMODBUS_RTU_H_
+#define _UMODBUS_RTU_H_
+
+#include <Stream.h>
+#include "umodbus.h"
+#include "umodbus_crc.h"
+
+// unit id + 253 bytes pdu + crc.
+#ifndef UMODBUS_RTU_BUFFER_SIZE
+#define UMODBUS_RTU_BUFFER_SIZE     (UMODBUS_MAX_PDU_SIZE + 3)
+#endif
+
+#define UMODBUS_RTU_BROADCAST       0x00
+#define UMODBUS_RTU_MIN_FRAME_SIZE  4
+
+namespace umodbus {
+
+// Modbus RTU server. A frame ends after 3.5 character times of silence on the line, 
+// so poll() has to be called more often than that to tell back to back frames apart.
+class uModbusRtu: public uModbus
+{
+private:
+    Stream * serial;
+    uint32_t t35;
+    uint32_t last_byte;
+    uint8_t input_buffer[UMODBUS_RTU_BUFFER_SIZE];
+    size_t input_length;
+    bool overflow;
+    bool broadcast;
+    uint8_t output_buffer[UMODBUS_RTU_BUFFER_SIZE];
+public:
+    uModbusRtu(const uint8_t& unit_id, register_t * buff, const size_t & len);
+    ~uModbusRtu();
+
+    void begin(Stream * serial, const uint32_t & baud);
+    uint32_t get_frame_timeout();
+protected:
+    virtual size_t  receive();
+    virtual bool    prepare_response(frame_t & request, frame_t & response);
+    virtual void    send(const frame_t & response);
+};
+
+};
+
+#endif
@@ -4,84 +4,183 @@
 namespace umodbus {
 
 
-uModbusTcp::uModbusTcp(const uint8_t& unit_id, register_t * buff, const size_t & len) : uModbus(unit_id, buff, len) {
-    this->wr_cursor = 0;
+uModbusTcpServer::uModbusTcpServer(const uint8_t& unit_id, register_t * buff, const size_t & len, 
+    tcp_slot_t * slots, const size_t & slot_count) : uModbus(unit_id, buff, len) {
+    this->slots = slots;
+    this->slot_count = slot_count;
+    this->current = 0;
+    this->next = 0;
+    this->frame_size = 0;
+    this->served = 0;
+    this->output_length = 0;
+
+    for(size_t i = 0; i < slot_count; i++) {
+        this->release(slots[i]);
+    }
 }
 
-uModbusTcp::~uModbusTcp() { }
+uModbusTcpServer::~uModbusTcpServer() { }
+
+bool    uModbusTcpServer::accept(Client * client) {
+    tcp_slot_t * free_slot = 0;
 
-uint8_t uModbusTcp::read() {
-    int val;
-    while((val = this->client->read()) < 0);
-    return (uint8_t)val;
+    for(size_t i = 0; i < this->slot_count; i++) {
+        if(this->slots[i].client == client) {
+            return true;
+        } else if(free_slot == 0 && this->slots[i].client == 0) {
+            free_slot = this->slots + i;
+        }
+    }
+
+    if(free_slot != 0) {
+        free_slot->client = client;
+        free_slot->length = 0;
+    }
+
+    return free_slot != 0;
 }
 
-size_t  uModbusTcp::read(uint8_t * buff, const size_t & len) {
-    if(this->client->connected()) {
-        size_t size = (size_t)(this->client->read(buff, len));
-        return size;
-    } else return 0;
+void    uModbusTcpServer::disconnect(Client * client) {
+    for(size_t i = 0; i < this->slot_count; i++) {
+        if(this->slots[i].client == client) {
+            this->release(this->slots[i]);
+        }
+    }
 }
 
-void    uModbusTcp::write(const uint8_t & val) {
-    if(this->wr_cursor < UMODBUS_TCP_BUFFER_SIZE) {
-        this->output_buffer[this->wr_cursor] = val;
-        this->wr_cursor += 1;
+size_t  uModbusTcpServer::connections() {
+    size_t count = 0;
+
+    for(size_t i = 0; i < this->slot_count; i++) {
+        count += (this->slots[i].client != 0) ? 1 : 0;
     }
+
+    return count;
 }
 
-size_t  uModbusTcp::write(const uint8_t * buff, const size_t & len) {
-    if((this->wr_cursor + len) < UMODBUS_TCP_BUFFER_SIZE) {
-        memcpy(this->output_buffer + this->wr_cursor, buff, len);
-        this->wr_cursor += len;
+void    uModbusTcpServer::poll() {
+    // every slot gets one turn, starting one further on each poll so none is favoured.
+    // a turn answers every request already received, up to the pipeline depth.
+    for(size_t i = 0; i < this->slot_count; i++) {
+        this->current = (this->next + i) % this->slot_count;
+        this->served = 0;
+        uModbus::poll();
+
+        if(this->slots[this->current].client != 0) {
+            this->flush(this->slots[this->current]);
+        }
     }
+
+    this->next = (this->slot_count > 0) ? (this->next + 1) % this->slot_count : 0;
 }
 
-bool    uModbusTcp::prepare_response() {    
-    mbap_header_t header;
-    delay(10);
-    this->wr_cursor = 0;
+void    uModbusTcpServer::release(tcp_slot_t & slot) {
+    slot.client = 0;
+    slot.length = 0;
+}
+
+size_t  uModbusTcpServer::receive(tcp_slot_t & slot) {
+    size_t space = UMODBUS_TCP_BUFFER_SIZE - slot.length;
+    int available = slot.client->available();
+    int size = 0;
+
+    // take only what already arrived, never wait for the rest of a frame.
+    if(available > 0 && space > 0) {
+        size = slot.client->read(slot.buffer + slot.length, ((size_t)available < space) ? (size_t)available : space);
+        slot.length += (size > 0) ? (size_t)size : 0;
+    }
+
+    return (size > 0) ? (size_t)size : 0;
+}
 
-    if(this->data_available()) {
+void    uModbusTcpServer::flush(tcp_slot_t & slot) {
+    if(this->output_length > 0 && slot.client->connected()) {
+        slot.client->write(this->output_buffer, this->output_length);
+    }
 
-        this->read_data(header.transaction_identifier);     // read mbap header
-        this->read_data(header.protocol_id);                // read mbap header
-        this->read_data(header.length);                     // read mbap header
-        header.unit_id = this->read();                      // read mbap header
+    this->output_length = 0;
+}
 
-        // copy the header into response buffer as-is. will be updated later.
-        this->write_data(header.transaction_identifier);   
-        this->write_data(header.protocol_id);
-        this->write_data(header.length);   
-        this->write(header.unit_id);        // Should validate unit_id. Not implemented yet.
+bool    uModbusTcpServer::prepare_response(frame_t & request, frame_t & response) {    
+    tcp_slot_t & slot = this->slots[this->current];
+    size_t space;
 
-        return true;
-    } else {
+    if(slot.client == 0 || this->served >= UMODBUS_TCP_PIPELINE_DEPTH) {
+        return false;
+    } else if(!slot.client->connected()) {
+        this->output_length = 0;
+        slot.client->stop();
+        this->release(slot);
         return false;
     }
+
+    this->frame_size = mbap_frame_size(slot.buffer, slot.length);
+
+    if(this->frame_size == UMODBUS_MBAP_INCOMPLETE) {
+        this->receive(slot);
+        this->frame_size = mbap_frame_size(slot.buffer, slot.length);
+    }
+
+    if(this->frame_size == UMODBUS_MBAP_INVALID 
+        || (this->frame_size == UMODBUS_MBAP_INCOMPLETE && slot.length == UMODBUS_TCP_BUFFER_SIZE)) {
+        // a stream can not resynchronise after a bad or oversized header.
+        this->count_frame_error();
+        this->output_length = 0;
+        slot.client->stop();
+        this->release(slot);
+        return false;
+    } else if(this->frame_size == UMODBUS_MBAP_INCOMPLETE) {
+        return false;
+    }
+
+    if((UMODBUS_TCP_OUTPUT_SIZE - this->output_length) < UMODBUS_TCP_BUFFER_SIZE) {
+        this->flush(slot);
+    }
+
+    // copy the header into response buffer as-is, unit id included. length is updated on send.
+    // the server is addressed by its IP address, any unit id is answered (0xFF by convention).
+    space = UMODBUS_TCP_OUTPUT_SIZE - this->output_length;
+    memcpy(this->output_buffer + this->output_length, slot.buffer, UMODBUS_MBAP_SIZE);
+
+    request.ptr = slot.buffer + UMODBUS_MBAP_SIZE;
+    request.size = this->frame_size - UMODBUS_MBAP_SIZE;
+    response.ptr = this->output_buffer + this->output_length + UMODBUS_MBAP_SIZE;
+    response.size = ((space < UMODBUS_TCP_BUFFER_SIZE) ? space : UMODBUS_TCP_BUFFER_SIZE) - UMODBUS_MBAP_SIZE;
+
+    return true;
 }
 
-void    uModbusTcp::send() {
-    uint16_t size = this->wr_cursor - 6;
-    uint8_t * len = this->output_buffer + 4;
-    *(len)      = (uint8_t)((size & 0xFF00) >> 8);
-    *(len + 1)  = (uint8_t)((size & 0x00FF));
-    
-    if(this->client != 0 && this->client->connected()) {
-        this->client->write(this->output_buffer, this->wr_cursor);
+void    uModbusTcpServer::send(const frame_t & response) {
+    tcp_slot_t & slot = this->slots[this->current];
+
+    // queue the response behind those of earlier pipelined requests. flush() writes them at once.
+    if(response.size > 0) {
+        umodbus_store_u16(this->output_buffer + this->output_length + 4, (uint16_t)(response.size + 1));
+        this->output_length += UMODBUS_MBAP_SIZE + response.size;
     }
+
+    // drop the answered frame, keeping any bytes of the next one.
+    slot.length -= this->frame_size;
+    memmove(slot.buffer, slot.buffer + this->frame_size, slot.length);
+    this->frame_size = 0;
+    this->served++;
 }
 
+uModbusTcp::uModbusTcp(const uint8_t& unit_id, register_t * buff, const size_t & len) 
+    : uModbusTcpServer(unit_id, buff, len, &(this->slot), 1) { }
+
+uModbusTcp::~uModbusTcp() { }
+
 void    uModbusTcp::accept(Client * client) {
-    this->client = client;
-}
+    if(this->slot.client != client) {
+        this->release(this->slot);
+    }
 
-void    uModbusTcp::disconnect() {
-    this->client = 0;
+    uModbusTcpServer::accept(client);
 }
 
-bool    uModbusTcp::data_available() {
-    return this->client->available() > 0;
+void    uModbusTcp::disconnect() {
+    this->release(this->slot);
 }
 
-};
\ No newline at end of file
+};
@@ -3,40 +3,81 @@
 
 #include <Client.h>
 #include "umodbus.h"
+#include "umodbus_mbap.h"
 
+// one full adu: mbap header + 253 bytes pdu. smaller buffers answer large reads with exception 04.
 #ifndef UMODBUS_TCP_BUFFER_SIZE
-#define UMODBUS_TCP_BUFFER_SIZE     50
+#define UMODBUS_TCP_BUFFER_SIZE     UMODBUS_MBAP_MAX_FRAME_SIZE
+#endif
+
+// responses of pipelined requests are coalesced here, flushing whenever 
+// the next response might not fit. AVR keeps a single response to spare SRAM.
+#ifndef UMODBUS_TCP_OUTPUT_SIZE
+#if defined(__AVR__)
+#define UMODBUS_TCP_OUTPUT_SIZE     UMODBUS_TCP_BUFFER_SIZE
+#else
+#define UMODBUS_TCP_OUTPUT_SIZE     (2 * UMODBUS_TCP_BUFFER_SIZE)
+#endif
+#endif
+
+// requests answered per slot on each poll, so a busy master can not starve the others.
+#ifndef UMODBUS_TCP_PIPELINE_DEPTH
+#define UMODBUS_TCP_PIPELINE_DEPTH  16
+#endif
+
+#if UMODBUS_TCP_OUTPUT_SIZE < UMODBUS_TCP_BUFFER_SIZE
+#error "UMODBUS_TCP_OUTPUT_SIZE must hold at least one UMODBUS_TCP_BUFFER_SIZE response"
 #endif
 
 namespace umodbus {
 
-typedef struct __attribute__ ((__packed__)) {
-    uint16_t transaction_identifier;
-    uint16_t protocol_id;
-    uint16_t length;
-    uint8_t unit_id;
-} mbap_header_t;
+// Per connection state: the client and the bytes received so far.
+typedef struct {
+    Client * client;
+    uint8_t buffer[UMODBUS_TCP_BUFFER_SIZE];
+    size_t length;
+} tcp_slot_t;
 
-class uModbusTcp: public uModbus
+// Serves up to slot_count clients over the same register tables. 
+// The slots array is owned by the caller, so its size is fixed at compile time.
+class uModbusTcpServer: public uModbus
 {
 private:
-    Client * client;
-    uint8_t output_buffer[UMODBUS_TCP_BUFFER_SIZE];
-    size_t wr_cursor = 0;
+    tcp_slot_t * slots;
+    size_t slot_count;
+    size_t current;
+    size_t next;
+    size_t frame_size;
+    size_t served;
+    uint8_t output_buffer[UMODBUS_TCP_OUTPUT_SIZE];
+    size_t output_length;
+public:
+    uModbusTcpServer(const uint8_t& unit_id, register_t * buff, const size_t & len, tcp_slot_t * slots, const size_t & slot_count);
+    virtual ~uModbusTcpServer();
+
+    bool accept(Client * client);
+    void disconnect(Client * client);
+    size_t connections();
+
+    virtual void poll();
+protected:
+    void            release(tcp_slot_t & slot);
+    virtual size_t  receive(tcp_slot_t & slot);
+    virtual void    flush(tcp_slot_t & slot);
+    virtual bool    prepare_response(frame_t & request, frame_t & response);
+    virtual void    send(const frame_t & response);
+};
+
+class uModbusTcp: public uModbusTcpServer
+{
+private:
+    tcp_slot_t slot;
 public:
     uModbusTcp(const uint8_t& unit_id, register_t * buff, const size_t & len);
     ~uModbusTcp();
 
     void accept(Client * client);
     void disconnect();
-protected:
-    virtual uint8_t read();
-    virtual size_t  read(uint8_t * buff, const size_t & len);
-    virtual void    write(const uint8_t & val);
-    virtual size_t  write(const uint8_t * buff, const size_t & len);
-    virtual bool    prepare_response();
-    virtual bool    data_available();
-    virtual void    send();
 };
 
 };
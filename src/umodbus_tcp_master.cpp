@@ -0,0 +1,160 @@
+#include "umodbus_tcp_master.h"
+#include <Arduino.h>
+
+namespace umodbus {
+
+uModbusTcpMaster::uModbusTcpMaster(register_t * buff, const size_t & len, read_request_t * requests, const size_t & capacity, 
+    const uint16_t & max_gap) : uModbusMaster(buff, len, requests, capacity, max_gap) {
+    this->client = 0;
+    this->unit_id = 0;
+    this->transaction = 0;
+    this->next = 0;
+    this->outstanding = 0;
+    this->completed = 0;
+    this->failed = 0;
+    this->timeout = UMODBUS_TCP_MASTER_TIMEOUT;
+    this->last_activity = 0;
+    this->length = 0;
+}
+
+uModbusTcpMaster::~uModbusTcpMaster() { }
+
+void    uModbusTcpMaster::begin(Client * client, const uint8_t & unit_id, const unsigned long & timeout) {
+    this->client = client;
+    this->unit_id = unit_id;
+    this->timeout = timeout;
+    this->next = 0;
+    this->outstanding = 0;
+    this->completed = 0;
+    this->length = 0;
+}
+
+bool    uModbusTcpMaster::poll() {
+    size_t count = this->get_request_count();
+
+    if(this->client == 0) {
+        return false;
+    }
+
+    if(this->next == 0) {
+        // a fresh range of ids per cycle, so late answers to an abandoned cycle are ignored.
+        this->transaction += (uint16_t)count;
+        this->completed = 0;
+        this->failed = 0;
+    }
+
+    if(!this->client->connected()) {
+        this->abort();
+    } else {
+        this->transmit();
+        this->receive();
+
+        if(this->outstanding > 0 && (millis() - this->last_activity) > this->timeout) {
+            this->abort();
+        }
+    }
+
+    if(this->completed == count) {
+        this->next = 0;
+        this->outstanding = 0;
+        return true;
+    }
+
+    return false;
+}
+
+size_t  uModbusTcpMaster::failures() {
+    return this->failed;
+}
+
+void    uModbusTcpMaster::transmit() {
+    read_request_t * requests = this->get_requests();
+    size_t count = this->get_request_count();
+    size_t size = 0;
+    mbap_header_t header;
+
+    header.protocol_id = 0;
+    header.length = 6;
+    header.unit_id = this->unit_id;
+
+    // top the pipeline up and hand every new request to the client in a single write.
+    for(; this->outstanding < UMODBUS_TCP_MASTER_PIPELINE_DEPTH && this->next < count; this->next++, this->outstanding++) {
+        header.transaction_identifier = (uint16_t)(this->transaction + this->next);
+        mbap_write_header(this->output_buffer + size, header);
+        size += UMODBUS_MBAP_SIZE;
+        size += this->encode_request(this->next, this->output_buffer + size, UMODBUS_TCP_MASTER_REQUEST_SIZE - UMODBUS_MBAP_SIZE);
+        requests[this->next].status = UMODBUS_REQUEST_PENDING;
+    }
+
+    if(size > 0) {
+        this->client->write(this->output_buffer, size);
+        this->last_activity = millis();
+    }
+}
+
+size_t  uModbusTcpMaster::receive() {
+    read_request_t * requests = this->get_requests();
+    size_t count = this->get_request_count();
+    size_t space = UMODBUS_TCP_BUFFER_SIZE - this->length;
+    int available = this->client->available();
+    int size = 0;
+    size_t frame_size;
+    mbap_header_t header;
+
+    if(available > 0 && space > 0) {
+        size = this->client->read(this->buffer + this->length, ((size_t)available < space) ? (size_t)available : space);
+        this->length += (size > 0) ? (size_t)size : 0;
+    }
+
+    if(size > 0) {
+        this->last_activity = millis();
+    }
+
+    while((frame_size = mbap_frame_size(this->buffer, this->length)) != UMODBUS_MBAP_INCOMPLETE) {
+        uint16_t index;
+
+        if(frame_size == UMODBUS_MBAP_INVALID) {
+            // the stream can not resynchronise, start over on a fresh connection.
+            this->client->stop();
+            this->abort();
+            break;
+        }
+
+        mbap_read_header(this->buffer, header);
+        index = (uint16_t)(header.transaction_identifier - this->transaction);
+
+        if(index < count && requests[index].status == UMODBUS_REQUEST_PENDING) {
+            bool valid = header.unit_id == this->unit_id 
+                && this->decode_response(index, this->buffer + UMODBUS_MBAP_SIZE, frame_size - UMODBUS_MBAP_SIZE);
+
+            requests[index].status = valid ? UMODBUS_REQUEST_DONE : UMODBUS_REQUEST_FAILED;
+            this->failed += valid ? 0 : 1;
+            this->outstanding--;
+            this->completed++;
+        }
+
+        this->length -= frame_size;
+        memmove(this->buffer, this->buffer + frame_size, this->length);
+    }
+
+    return (size > 0) ? (size_t)size : 0;
+}
+
+void    uModbusTcpMaster::abort() {
+    read_request_t * requests = this->get_requests();
+    size_t count = this->get_request_count();
+
+    // fail whatever is in flight or still unsent, the cycle ends here.
+    for(size_t i = 0; i < count; i++) {
+        if(requests[i].status == UMODBUS_REQUEST_PENDING || i >= this->next) {
+            requests[i].status = UMODBUS_REQUEST_FAILED;
+            this->failed++;
+        }
+    }
+
+    this->completed = count;
+    this->outstanding = 0;
+    this->length = 0;
+}
+
+};
@@ -0,0 +1,59 @@
+#ifndef _UMODBUS_TCP_MASTER_H_
+#define _UMODBUS_TCP_MASTER_H_
+
+#include <Client.h>
+#include "umodbus_master.h"
+#include "umodbus_tcp.h"
+
+// requests in flight per connection. many devices queue only a few, the rest are sent as answers arrive.
+#ifndef UMODBUS_TCP_MASTER_PIPELINE_DEPTH
+#define UMODBUS_TCP_MASTER_PIPELINE_DEPTH   8
+#endif
+
+#ifndef UMODBUS_TCP_MASTER_TIMEOUT
+#define UMODBUS_TCP_MASTER_TIMEOUT          1000
+#endif
+
+#define UMODBUS_TCP_MASTER_REQUEST_SIZE     (UMODBUS_MBAP_SIZE + 5)
+
+namespace umodbus {
+
+// Polls one device over TCP. Every planned request gets its own transaction
+// id, so up to the pipeline depth are on the wire at once and answers are 
+// matched by id in whatever order they come back.
+class uModbusTcpMaster: public uModbusMaster
+{
+private:
+    Client * client;
+    uint8_t unit_id;
+    uint16_t transaction;
+    size_t next;
+    size_t outstanding;
+    size_t completed;
+    size_t failed;
+    unsigned long timeout;
+    unsigned long last_activity;
+    uint8_t buffer[UMODBUS_TCP_BUFFER_SIZE];
+    size_t length;
+    uint8_t output_buffer[UMODBUS_TCP_MASTER_PIPELINE_DEPTH * UMODBUS_TCP_MASTER_REQUEST_SIZE];
+public:
+    uModbusTcpMaster(register_t * buff, const size_t & len, read_request_t * requests, const size_t & capacity, 
+        const uint16_t & max_gap = UMODBUS_MASTER_MAX_GAP);
+    virtual ~uModbusTcpMaster();
+
+    void begin(Client * client, const uint8_t & unit_id, const unsigned long & timeout = UMODBUS_TCP_MASTER_TIMEOUT);
+
+    // Never blocks. Returns true when the current cycle is over, every request
+    // being done or failed, and the next call starts reading the map again.
+    bool poll();
+    // requests of the last finished cycle that got no valid answer.
+    size_t failures();
+protected:
+    void            transmit();
+    virtual size_t  receive();
+    void            abort();
+};
+
+};
+
+#endif
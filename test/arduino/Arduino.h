@@ -0,0 +1,28 @@
+#ifndef _ARDUINO_MOCK_H_
+#define _ARDUINO_MOCK_H_
+
+// Host stand-in for the parts of the Arduino core used by the transports.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// tests move the clock by hand.
+inline unsigned long & mock_micros() {
+	static unsigned long now = 0;
+	return now;
+}
+
+inline unsigned long micros() {
+	return mock_micros();
+}
+
+inline unsigned long millis() {
+	return mock_micros() / 1000;
+}
+
+inline void delay(unsigned long ms) {
+	mock_micros() += ms * 1000;
+}
+
+#endif
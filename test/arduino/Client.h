@@ -0,0 +1,18 @@
+#ifndef _CLIENT_MOCK_H_
+#define _CLIENT_MOCK_H_
+
+#include "Arduino.h"
+
+class Client {
+public:
+	virtual ~Client() { }
+
+	virtual int available() = 0;
+	virtual int read() = 0;
+	virtual int read(uint8_t * buf, size_t size) = 0;
+	virtual size_t write(const uint8_t * buf, size_t size) = 0;
+	virtual uint8_t connected() = 0;
+	virtual void stop() = 0;
+};
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef _STREAM_MOCK_H_
+#define _STREAM_MOCK_H_
+
+#include "Arduino.h"
+
+class Stream {
+public:
+	virtual ~Stream() { }
+
+	virtual int available() = 0;
+	virtual int read() = 0;
+	virtual size_t write(uint8_t val) = 0;
+
+	virtual size_t write(const uint8_t * buf, size_t size) {
+		size_t n = 0;
+		while(n < size && this->write(buf[n])) {
+			n++;
+		}
+		return n;
+	}
+
+	virtual void flush() { }
+};
+
+#endif
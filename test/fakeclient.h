@@ -0,0 +1,71 @@
+/*
+Copyright 2020 Jerson Leonardo Huerfano Romero
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef _FAKE_CLIENT_H_
+#define _FAKE_CLIENT_H_
+
+#include <string.h>
+#include <vector>
+#include <Client.h>
+
+class FakeClient : public Client {
+public:
+	std::vector<uint8_t> rx;
+	std::vector<uint8_t> tx;
+	size_t writes;
+	bool open;
+
+	FakeClient() : writes(0), open(true) { }
+
+	void push(const uint8_t * buf, size_t size) {
+		rx.insert(rx.end(), buf, buf + size);
+	}
+
+	virtual int available() {
+		return (int)rx.size();
+	}
+
+	virtual int read() {
+		if(rx.empty()) {
+			return -1;
+		}
+		int val = rx.front();
+		rx.erase(rx.begin());
+		return val;
+	}
+
+	virtual int read(uint8_t * buf, size_t size) {
+		size_t len = (size < rx.size()) ? size : rx.size();
+		memcpy(buf, rx.data(), len);
+		rx.erase(rx.begin(), rx.begin() + len);
+		return (int)len;
+	}
+
+	virtual size_t write(const uint8_t * buf, size_t size) {
+		tx.insert(tx.end(), buf, buf + size);
+		writes++;
+		return size;
+	}
+
+	virtual uint8_t connected() {
+		return open;
+	}
+
+	virtual void stop() {
+		open = false;
+	}
+};
+
+#endif
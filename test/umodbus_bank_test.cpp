@@ -0,0 +1,86 @@
+/*
+Copyright 2020 Jerson Leonardo Huerfano Romero
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+
+#include "umodbus.h"
+#include "umodbus_bank.h"
+
+using namespace testing;
+
+TEST(uModbusBankTest, commitPublishesCycle) {
+	umodbus::umodbus_bank_t bank;
+	uint16_t storage[8];
+	uint16_t cycle[4] = { 1, 2, 3, 4 };
+	uint16_t snapshot[4];
+	uint8_t wire[4];
+
+	umodbus::umodbus_bank_init(&bank, storage, 4);
+	umodbus::umodbus_bank_snapshot(&bank, snapshot, 0, 4);
+	ASSERT_EQ(0, snapshot[0]);
+	ASSERT_EQ(0, snapshot[3]);
+
+	umodbus::umodbus_bank_commit(&bank, cycle);
+	cycle[0] = 5;
+	umodbus::umodbus_bank_snapshot(&bank, snapshot, 1, 3);
+	ASSERT_EQ(2, snapshot[0]);
+	ASSERT_EQ(4, snapshot[2]);
+
+	umodbus::umodbus_bank_commit(&bank, cycle);
+	umodbus::umodbus_bank_to_wire(&bank, wire, 0, 2);
+	ASSERT_EQ(0x00, wire[0]);
+	ASSERT_EQ(0x05, wire[1]);
+	ASSERT_EQ(0x00, wire[2]);
+	ASSERT_EQ(0x02, wire[3]);
+}
+
+TEST(uModbusBankTest, snapshotsAreConsistent) {
+	umodbus::umodbus_bank_t bank;
+	uint16_t storage[128];
+	std::atomic<bool> done(false);
+
+	umodbus::umodbus_bank_init(&bank, storage, 64);
+
+	// every commit holds a single value in all its words, a torn read would mix two.
+	std::thread producer([&bank, &done]() {
+		uint16_t cycle[64];
+
+		for(uint16_t n = 1; n < 20000; n++) {
+			for(size_t i = 0; i < 64; i++) {
+				cycle[i] = n;
+			}
+			umodbus::umodbus_bank_commit(&bank, cycle);
+		}
+		done = true;
+	});
+
+	size_t torn = 0;
+
+	// no assertion before join(), a running std::thread going out of scope aborts.
+	while(!done) {
+		uint16_t snapshot[64];
+
+		umodbus::umodbus_bank_snapshot(&bank, snapshot, 0, 64);
+
+		for(size_t i = 1; i < 64; i++) {
+			torn += (snapshot[0] != snapshot[i]) ? 1 : 0;
+		}
+	}
+
+	producer.join();
+	ASSERT_EQ(0, torn);
+}
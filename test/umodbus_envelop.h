@@ -8,19 +8,11 @@
 
 class uModbusEnvelop : umodbus::uModbus {
 	array_t<uint8_t> read_buf;
-	size_t read_cursor;
 	array_t<uint8_t> write_buf;
-	size_t write_cursor;
 public:
-	uModbusEnvelop() : uModbus() { 
-		this->read_cursor = 0;
-		this->write_cursor = 0;
-	}
+	uModbusEnvelop() : uModbus() { }
 
-	uModbusEnvelop(const uint8_t & unit_id, umodbus::register_t * buff, const size_t &len) : uModbus(unit_id, buff, len) { 
-		this->read_cursor = 0;
-		this->write_cursor = 0;
-	}
+	uModbusEnvelop(const uint8_t & unit_id, umodbus::register_t * buff, const size_t &len) : uModbus(unit_id, buff, len) { }
 
 	virtual ~uModbusEnvelop() { }
 
@@ -32,86 +24,84 @@ public:
 		return &(this->write_buf);
 	}
 
-	size_t get_read_cursor() {
-		return this->read_cursor;
+	bool enveloped_set_registers(umodbus::register_t * buff, const size_t & len) {
+		return this->set_registers(buff, len);
 	}
 
-	size_t get_write_cursor() {
-		return this->write_cursor;
+	bool enveloped_set_registers_P(const umodbus::register_t * buff, const size_t & len) {
+		return this->set_registers_P(buff, len);
 	}
 
-    size_t enveloped_binary_search(const uint8_t & address) {
-        return this->binary_search(address);
-    }
-
-    void enveloped_read_as_byte(const uint8_t & fnc) {
-        this->read_as_byte(fnc);
-    }
-
-    void enveloped_read_as_register(const uint8_t & fnc) {
-        this->read_as_register(fnc);
-    }
-
-    void enveloped_write_single_as_byte(const uint8_t & fnc) {
-        this->write_single_as_byte(fnc);
-    }
+	void enveloped_set_map(const umodbus::register_map_t & map) {
+		this->set_map(map);
+	}
 
-	void enveloped_write_single_as_register(const uint8_t & fnc) {
-        this->write_single_as_register(fnc);
-    }
+	void enveloped_set_write_callback(umodbus::write_callback_t callback, void * context) {
+		this->set_write_callback(callback, context);
+	}
 
-	void enveloped_write_multiple_as_byte(const uint8_t & fnc) {
-		this->write_multiple_as_byte(fnc);
+	bool enveloped_set_device_identification(const umodbus::device_object_t * objects, const size_t & len, uint8_t * buff, const size_t & size) {
+		return this->set_device_identification(objects, len, buff, size);
 	}
 
-	void enveloped_write_multiple_registers(const uint8_t & fnc) {
-		this->write_multiple_as_register(fnc);
+#ifdef UMODBUS_STATS
+	const umodbus::umodbus_stats_t * enveloped_get_stats() {
+		return this->get_stats();
 	}
+#endif
 
-protected:
-	virtual uint8_t read() {
-		if(this->read_cursor < this->read_buf.size) {
-			return *(this->read_buf.ptr + this->read_cursor++);
-		} else {
-			return 0;
-		}
+	size_t enveloped_find_register(const uint8_t & table, const uint16_t & address) {
+		return this->find_register(table, address);
 	}
 
-    virtual size_t  read(uint8_t * buff, const size_t & len) {
-		size_t realLen = ((this->read_buf.size - this->read_cursor) >= len) ? len : (this->read_buf.size - this->read_cursor);
-		
-		memcpy(buff, this->read_buf.ptr + this->read_cursor, realLen);
+	size_t enveloped_find_range(const uint8_t & table, const uint16_t & address, const uint16_t & count) {
+		return this->find_range(table, address, count);
+	}
 
-        this->read_cursor += realLen;
+	size_t enveloped_process(const size_t & len) {
+		return this->process(this->read_buf.ptr, len, this->write_buf.ptr, this->write_buf.size);
+	}
 
-		return realLen;
+	void enveloped_read_as_byte(const uint8_t & fnc) {
+		this->bind_buffers();
+		this->read_as_byte(fnc);
 	}
 
-    virtual void    write(const uint8_t & val) {
-		if(this->write_cursor < this->write_buf.size) {
-			*(this->write_buf.ptr + this->write_cursor++) = val;
-		}
+	void enveloped_read_as_register(const uint8_t & fnc) {
+		this->bind_buffers();
+		this->read_as_register(fnc);
 	}
 
-    virtual size_t  write(const uint8_t * buff, const size_t & len) {
-		size_t realLen = ((this->write_buf.size - this->write_cursor) >= len) ? len : (this->write_buf.size - this->write_cursor);
+	void enveloped_write_single_as_byte(const uint8_t & fnc) {
+		this->bind_buffers();
+		this->write_single_as_byte(fnc);
+	}
 
-		memcpy(this->write_buf.ptr + this->write_cursor, buff, realLen);
+	void enveloped_write_single_as_register(const uint8_t & fnc) {
+		this->bind_buffers();
+		this->write_single_as_register(fnc);
+	}
 
-        this->write_cursor += realLen;
+	void enveloped_write_multiple_as_byte(const uint8_t & fnc) {
+		this->bind_buffers();
+		this->write_multiple_as_byte(fnc);
+	}
 
-		return realLen;
+	void enveloped_write_multiple_registers(const uint8_t & fnc) {
+		this->bind_buffers();
+		this->write_multiple_as_register(fnc);
 	}
 
-    virtual bool    prepare_response() {
-		return true;
+protected:
+	void bind_buffers() {
+		this->bind(this->read_buf.ptr, this->read_buf.size, this->write_buf.ptr, this->write_buf.size);
 	}
 
-	virtual void    send() { 
-		return;
+	virtual bool    prepare_response(umodbus::frame_t & request, umodbus::frame_t & response) {
+		return false;
 	}
 
-	virtual void    read_mei_type(const uint8_t & fnc) {
+	virtual void    send(const umodbus::frame_t & response) { 
 		return;
 	}
 
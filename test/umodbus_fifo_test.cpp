@@ -0,0 +1,71 @@
+/*
+Copyright 2020 Jerson Leonardo Huerfano Romero
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <gtest/gtest.h>
+#include <thread>
+
+#include "umodbus.h"
+#include "umodbus_fifo.h"
+
+using namespace testing;
+
+TEST(uModbusFifoTest, fillAndDrain) {
+	umodbus::umodbus_fifo_t fifo;
+	uint8_t wire[UMODBUS_FIFO_CAPACITY * 2];
+
+	umodbus::umodbus_fifo_init(&fifo);
+
+	for(uint16_t i = 0; i < UMODBUS_FIFO_CAPACITY; i++) {
+		ASSERT_TRUE(umodbus::umodbus_fifo_push(&fifo, 0x0100 + i));
+	}
+
+	ASSERT_FALSE(umodbus::umodbus_fifo_push(&fifo, 0xFFFF));
+	ASSERT_EQ(UMODBUS_FIFO_CAPACITY, umodbus::umodbus_fifo_count(&fifo));
+
+	ASSERT_EQ(2, umodbus::umodbus_fifo_pop_to_wire(&fifo, wire, 2));
+	ASSERT_EQ(0x01, wire[0]);
+	ASSERT_EQ(0x00, wire[1]);
+	ASSERT_EQ(0x01, wire[2]);
+	ASSERT_EQ(0x01, wire[3]);
+
+	ASSERT_EQ(UMODBUS_FIFO_CAPACITY - 2, umodbus::umodbus_fifo_pop_to_wire(&fifo, wire, UMODBUS_FIFO_CAPACITY));
+	ASSERT_EQ(0, umodbus::umodbus_fifo_count(&fifo));
+}
+
+TEST(uModbusFifoTest, producerThread) {
+	umodbus::umodbus_fifo_t fifo;
+	uint8_t wire[UMODBUS_FIFO_CAPACITY * 2];
+	uint16_t expected = 0;
+
+	umodbus::umodbus_fifo_init(&fifo);
+
+	std::thread producer([&fifo]() {
+		for(uint16_t i = 0; i < 10000;) {
+			if(umodbus::umodbus_fifo_push(&fifo, i)) {
+				i++;
+			}
+		}
+	});
+
+	while(expected < 10000) {
+		uint8_t n = umodbus::umodbus_fifo_pop_to_wire(&fifo, wire, UMODBUS_FIFO_CAPACITY);
+
+		for(uint8_t i = 0; i < n; i++, expected++) {
+			ASSERT_EQ(expected, umodbus::umodbus_load_u16(wire + i * 2));
+		}
+	}
+
+	producer.join();
+}
@@ -0,0 +1,159 @@
+/*
+Copyright 2020 Jerson Leonardo Huerfano Romero
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <gtest/gtest.h>
+
+#include "umodbus.h"
+#include "umodbus_map.h"
+#include "umodbus_envelop.h"
+
+using namespace testing;
+
+static uint16_t setpoints[4] = { 0x1001, 0x1002, 0x1003, 0x1004 };
+static uint16_t mode = 0x0042;
+static uint16_t limits[2] = { 0x2001, 0x2002 };
+static float temperature = 1.0f;
+static uint16_t status[3];
+static uint8_t relays[2];
+
+// declared out of order: holding 0-3, 4, 8-9 with a gap at 5-7, input 0-2 and 3-4.
+typedef umodbus::umodbus_map<
+	UMODBUS_WORDS_ENTRY(8, UMODBUS_TYPE_HOLDING_REGISTER, limits),
+	UMODBUS_VALUE_ENTRY(3, UMODBUS_TYPE_INPUT_REGISTER, temperature),
+	UMODBUS_ENTRY(0, UMODBUS_TYPE_COIL_BITS, relays, 12),
+	UMODBUS_WORDS_ENTRY(0, UMODBUS_TYPE_HOLDING_REGISTER, setpoints),
+	UMODBUS_WORDS_ENTRY(0, UMODBUS_TYPE_INPUT_REGISTER, status),
+	UMODBUS_WORDS_ENTRY(4, UMODBUS_TYPE_HOLDING_REGISTER, mode)> test_map_t;
+
+static uint16_t point_a;
+static uint16_t point_b;
+static uint16_t point_c;
+
+typedef umodbus::umodbus_map<
+	UMODBUS_WORDS_ENTRY(12, UMODBUS_TYPE_HOLDING_REGISTER, point_a),
+	UMODBUS_WORDS_ENTRY(10, UMODBUS_TYPE_HOLDING_REGISTER, point_b),
+	UMODBUS_WORDS_ENTRY(11, UMODBUS_TYPE_HOLDING_REGISTER, point_c)> dense_map_t;
+
+// a few hundred points, declared back to front: the layout is planned once per map.
+template<size_t I>
+struct large_point {
+	static uint16_t value;
+};
+
+template<size_t I>
+uint16_t large_point<I>::value;
+
+template<typename Indices>
+struct large_map;
+
+template<size_t... I>
+struct large_map<umodbus::umodbus_indices<I...> > {
+	typedef umodbus::umodbus_map<
+		UMODBUS_WORDS_ENTRY(2 * (sizeof...(I) - 1 - I), UMODBUS_TYPE_HOLDING_REGISTER, large_point<I>::value)...> type;
+};
+
+typedef large_map<umodbus::umodbus_make_indices<400>::type>::type large_map_t;
+
+// the planner rejects what the static_asserts of umodbus_map would.
+static_assert(!umodbus::umodbus_plan_map<
+	UMODBUS_WORDS_ENTRY(0, UMODBUS_TYPE_HOLDING_REGISTER, setpoints),
+	UMODBUS_WORDS_ENTRY(3, UMODBUS_TYPE_HOLDING_REGISTER, mode)>().disjoint, "overlapping blocks");
+static_assert(!umodbus::umodbus_plan_map<
+	UMODBUS_WORDS_ENTRY(4, UMODBUS_TYPE_HOLDING_REGISTER, mode),
+	UMODBUS_WORDS_ENTRY(4, UMODBUS_TYPE_HOLDING_REGISTER, mode)>().disjoint, "duplicate address");
+static_assert(!umodbus::umodbus_plan_map<
+	UMODBUS_WORDS_ENTRY(0xFFFE, UMODBUS_TYPE_HOLDING_REGISTER, setpoints)>().in_range, "past 0xFFFF");
+static_assert(umodbus::umodbus_plan_map<
+	UMODBUS_WORDS_ENTRY(4, UMODBUS_TYPE_HOLDING_REGISTER, mode),
+	UMODBUS_WORDS_ENTRY(4, UMODBUS_TYPE_INPUT_REGISTER, mode)>().disjoint, "tables have their own addresses");
+
+TEST(uModbusMapTest, sortedIntoTables) {
+	const umodbus::register_map_t & map = test_map_t::map;
+	const umodbus::register_table_t * holding = map.tables + UMODBUS_TABLE_HOLDING_REGISTER;
+	const umodbus::register_table_t * input = map.tables + UMODBUS_TABLE_INPUT_REGISTER;
+
+	ASSERT_EQ(6, map.size);
+	ASSERT_EQ(0, map.tables[UMODBUS_TABLE_DISCRETE_INPUT].size);
+	ASSERT_EQ(1, map.tables[UMODBUS_TABLE_COIL].size);
+	ASSERT_EQ((uint16_t *)relays, map.tables[UMODBUS_TABLE_COIL].reg[0].ptr);
+
+	ASSERT_EQ(3, holding->size);
+	ASSERT_EQ(setpoints, holding->reg[0].ptr);
+	ASSERT_EQ(&mode, holding->reg[1].ptr);
+	ASSERT_EQ(limits, holding->reg[2].ptr);
+	ASSERT_FALSE(holding->dense);
+	ASSERT_EQ(10, holding->span);
+
+	ASSERT_EQ(2, input->size);
+	ASSERT_EQ(UMODBUS_STORAGE_VALUE, UMODBUS_GET_STORAGE(input->reg + 1));
+	ASSERT_EQ(2, input->reg[1].count);
+
+	ASSERT_TRUE(dense_map_t::map.tables[UMODBUS_TABLE_HOLDING_REGISTER].dense);
+	ASSERT_EQ(&point_b, dense_map_t::map.reg[0].ptr);
+	ASSERT_EQ(10, dense_map_t::map.tables[UMODBUS_TABLE_HOLDING_REGISTER].base);
+}
+
+TEST(uModbusMapTest, indexedLookups) {
+	uModbusEnvelop envelop;
+
+	envelop.enveloped_set_map(test_map_t::map);
+
+	ASSERT_EQ(0, envelop.enveloped_find_register(UMODBUS_TABLE_HOLDING_REGISTER, 3));
+	ASSERT_EQ(1, envelop.enveloped_find_register(UMODBUS_TABLE_HOLDING_REGISTER, 4));
+	ASSERT_EQ(SIZE_MAX, envelop.enveloped_find_register(UMODBUS_TABLE_HOLDING_REGISTER, 6));
+	ASSERT_EQ(2, envelop.enveloped_find_register(UMODBUS_TABLE_HOLDING_REGISTER, 9));
+	ASSERT_EQ(SIZE_MAX, envelop.enveloped_find_register(UMODBUS_TABLE_HOLDING_REGISTER, 10));
+	ASSERT_EQ(0, envelop.enveloped_find_range(UMODBUS_TABLE_HOLDING_REGISTER, 1, 4));
+	ASSERT_EQ(SIZE_MAX, envelop.enveloped_find_range(UMODBUS_TABLE_HOLDING_REGISTER, 3, 3));
+	ASSERT_EQ(1, envelop.enveloped_find_range(UMODBUS_TABLE_INPUT_REGISTER, 4, 1));
+}
+
+TEST(uModbusMapTest, readThroughMap) {
+	uModbusEnvelop envelop;
+	uint8_t request[] = { UMODBUS_FNCODE_RD_M_HOLDING_REG, 0x00, 0x03, 0x00, 0x02 };
+	uint8_t response[UMODBUS_MAX_PDU_SIZE];
+	uint8_t expected[] = { UMODBUS_FNCODE_RD_M_HOLDING_REG, 4, 0x10, 0x04, 0x00, 0x42 };
+
+	envelop.get_read_buf()->ptr = request;
+	envelop.get_write_buf()->ptr = response;
+	envelop.get_write_buf()->size = sizeof(response);
+	envelop.enveloped_set_map(test_map_t::map);
+
+	ASSERT_EQ(sizeof(expected), envelop.enveloped_process(sizeof(request)));
+	ASSERT_EQ(0, memcmp(expected, response, sizeof(expected)));
+
+	// 5-7 are not mapped.
+	request[2] = 0x00; request[4] = 0x06;
+	ASSERT_EQ(2, envelop.enveloped_process(sizeof(request)));
+	ASSERT_EQ(UMODBUS_FNCODE_RD_M_HOLDING_REG + 0x80, response[0]);
+	ASSERT_EQ(0x02, response[1]);
+}
+
+TEST(uModbusMapTest, largeMap) {
+	const umodbus::register_table_t * holding = large_map_t::map.tables + UMODBUS_TABLE_HOLDING_REGISTER;
+	uModbusEnvelop envelop;
+
+	ASSERT_EQ(400, holding->size);
+	ASSERT_FALSE(holding->dense);
+	ASSERT_EQ(0, holding->index);
+	ASSERT_EQ(&large_point<399>::value, holding->reg[0].ptr);
+	ASSERT_EQ(&large_point<0>::value, holding->reg[399].ptr);
+
+	envelop.enveloped_set_map(large_map_t::map);
+	ASSERT_EQ(0, envelop.enveloped_find_register(UMODBUS_TABLE_HOLDING_REGISTER, 0));
+	ASSERT_EQ(250, envelop.enveloped_find_register(UMODBUS_TABLE_HOLDING_REGISTER, 500));
+	ASSERT_EQ(SIZE_MAX, envelop.enveloped_find_register(UMODBUS_TABLE_HOLDING_REGISTER, 501));
+	ASSERT_EQ(399, envelop.enveloped_find_register(UMODBUS_TABLE_HOLDING_REGISTER, 798));
+}
@@ -0,0 +1,209 @@
+/*
+Copyright 2020 Jerson Leonardo Huerfano Romero
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <gtest/gtest.h>
+
+#include "umodbus.h"
+#include "umodbus_master.h"
+#include "umodbus_tcp_master.h"
+#include "fakeclient.h"
+
+using namespace testing;
+
+class uModbusMasterTest: public testing::Test {
+public:
+	uint16_t values[8];
+	uint16_t block[130];
+	uint8_t bits[2];
+	umodbus::register_t registers[8];
+	umodbus::read_request_t requests[8];
+
+	uModbusMasterTest() {
+		memset(values, 0, sizeof(values));
+		memset(block, 0, sizeof(block));
+		memset(bits, 0, sizeof(bits));
+	}
+};
+
+// answers a request the way a server holding address * 0x0101 at every register would.
+static size_t answer(const uint8_t * frame, uint8_t * response) {
+	uint16_t address = umodbus::umodbus_load_u16(frame + 8);
+	uint16_t count = umodbus::umodbus_load_u16(frame + 10);
+
+	memcpy(response, frame, UMODBUS_MBAP_SIZE);
+	umodbus::umodbus_store_u16(response + 4, (uint16_t)(3 + count * 2));
+	response[7] = frame[7];
+	response[8] = (uint8_t)(count * 2);
+
+	for(uint16_t i = 0; i < count; i++) {
+		umodbus::umodbus_store_u16(response + 9 + i * 2, (uint16_t)((address + i) * 0x0101));
+	}
+
+	return 9 + count * 2;
+}
+
+TEST_F(uModbusMasterTest, planMergesNearbyPoints) {
+	registers[0] = { 5, UMODBUS_TYPE_HOLDING_REGISTER, values + 0 };
+	registers[1] = { 0, UMODBUS_TYPE_HOLDING_REGISTER, values + 1 };
+	registers[2] = { 1, UMODBUS_TYPE_HOLDING_REGISTER, values + 2 };
+	registers[3] = { 2, UMODBUS_TYPE_INPUT_REGISTER, values + 3 };
+	umodbus::uModbusMaster master(registers, 4, requests, 8);
+
+	ASSERT_EQ(2, master.get_request_count());
+	ASSERT_EQ(UMODBUS_FNCODE_RD_M_HOLDING_REG, requests[0].fnc);
+	ASSERT_EQ(0, requests[0].address);
+	ASSERT_EQ(6, requests[0].count);
+	ASSERT_EQ(UMODBUS_FNCODE_RD_M_INPUT_REG, requests[1].fnc);
+	ASSERT_EQ(2, requests[1].address);
+	ASSERT_EQ(1, requests[1].count);
+
+	umodbus::uModbusMaster strict(registers, 4, requests, 8, 0);
+
+	ASSERT_EQ(3, strict.get_request_count());
+	ASSERT_EQ(2, requests[0].count);
+	ASSERT_EQ(5, requests[1].address);
+}
+
+TEST_F(uModbusMasterTest, planSplitsAtLimit) {
+	registers[0] = { 10, UMODBUS_TYPE_HOLDING_REGISTER, block, 130 };
+	registers[1] = { 140, UMODBUS_TYPE_HOLDING_REGISTER, values };
+	registers[2] = { 0, UMODBUS_TYPE_COIL_BITS, (uint16_t *)bits, 16 };
+	umodbus::uModbusMaster master(registers, 3, requests, 8);
+
+	ASSERT_EQ(3, master.get_request_count());
+	ASSERT_EQ(UMODBUS_FNCODE_RD_M_COIL, requests[0].fnc);
+	ASSERT_EQ(16, requests[0].count);
+	ASSERT_EQ(10, requests[1].address);
+	ASSERT_EQ(125, requests[1].count);
+	ASSERT_EQ(135, requests[2].address);
+	ASSERT_EQ(6, requests[2].count);
+
+	umodbus::uModbusMaster small(registers, 3, requests, 2);
+
+	ASSERT_FALSE(small.plan());
+}
+
+TEST_F(uModbusMasterTest, planKeepsNestedPoints) {
+	registers[0] = { 0, UMODBUS_TYPE_HOLDING_REGISTER, block, 4 };
+	registers[1] = { 1, UMODBUS_TYPE_HOLDING_REGISTER, values };
+	registers[2] = { 2, UMODBUS_TYPE_HOLDING_REGISTER, values + 1, 3 };
+	umodbus::uModbusMaster master(registers, 3, requests, 8, 0);
+
+	ASSERT_EQ(1, master.get_request_count());
+	ASSERT_EQ(0, requests[0].address);
+	ASSERT_EQ(5, requests[0].count);
+	ASSERT_EQ(2, requests[0].last);
+
+	// a point starting before a request split at the limit gets its own.
+	registers[0] = { 10, UMODBUS_TYPE_HOLDING_REGISTER, block, 130 };
+	registers[1] = { 100, UMODBUS_TYPE_HOLDING_REGISTER, values, 4 };
+	umodbus::uModbusMaster split(registers, 2, requests, 8, 0);
+
+	ASSERT_EQ(3, split.get_request_count());
+	ASSERT_EQ(135, requests[1].address);
+	ASSERT_EQ(5, requests[1].count);
+	ASSERT_EQ(100, requests[2].address);
+	ASSERT_EQ(4, requests[2].count);
+}
+
+TEST_F(uModbusMasterTest, decodeResponse) {
+	uint8_t pdu[16];
+	uint8_t coils[] = { UMODBUS_FNCODE_RD_M_COIL, 2, 0x05, 0x81 };
+	uint8_t exception[] = { UMODBUS_FNCODE_RD_M_HOLDING_REG + 0x80, 0x02 };
+	uint8_t holding[] = { UMODBUS_FNCODE_RD_M_HOLDING_REG, 6, 0x12, 0x34, 0xAA, 0xAA, 0x56, 0x78 };
+
+	registers[0] = { 0, UMODBUS_TYPE_COIL_BITS, (uint16_t *)bits, 10 };
+	registers[1] = { 15, UMODBUS_TYPE_COIL, values + 0 };
+	registers[2] = { 7, UMODBUS_TYPE_HOLDING_REGISTER, values + 1 };
+	registers[3] = { 9, UMODBUS_TYPE_HOLDING_REGISTER, values + 2 };
+	umodbus::uModbusMaster master(registers, 4, requests, 8);
+
+	ASSERT_EQ(2, master.get_request_count());
+	ASSERT_EQ(5, master.encode_request(1, pdu, sizeof(pdu)));
+	ASSERT_EQ(UMODBUS_FNCODE_RD_M_HOLDING_REG, pdu[0]);
+	ASSERT_EQ(7, umodbus::umodbus_load_u16(pdu + 1));
+	ASSERT_EQ(3, umodbus::umodbus_load_u16(pdu + 3));
+
+	ASSERT_TRUE(master.decode_response(0, coils, sizeof(coils)));
+	ASSERT_EQ(0x05, bits[0]);
+	ASSERT_EQ(0x01, bits[1] & 0x03);
+	ASSERT_EQ(UMODBUS_COIL_ON, values[0]);
+
+	ASSERT_FALSE(master.decode_response(1, exception, sizeof(exception)));
+	ASSERT_FALSE(master.decode_response(1, holding, sizeof(holding) - 1));
+	ASSERT_TRUE(master.decode_response(1, holding, sizeof(holding)));
+	ASSERT_EQ(0x1234, values[1]);
+	ASSERT_EQ(0x5678, values[2]);
+}
+
+TEST_F(uModbusMasterTest, tcpPipelinesRequests) {
+	FakeClient client;
+	uint8_t response[UMODBUS_TCP_BUFFER_SIZE];
+
+	for(uint16_t i = 0; i < 5; i++) {
+		registers[i] = { (uint16_t)(i * 20), UMODBUS_TYPE_HOLDING_REGISTER, values + i };
+	}
+
+	umodbus::uModbusTcpMaster master(registers, 5, requests, 8, 0);
+	master.begin(&client, 0x21);
+
+	ASSERT_FALSE(master.poll());
+	ASSERT_EQ(1, client.writes);
+	ASSERT_EQ(5 * UMODBUS_TCP_MASTER_REQUEST_SIZE, client.tx.size());
+
+	// answer in reverse order, the transaction id tells them apart.
+	for(size_t i = 5; i > 0; i--) {
+		client.push(response, answer(client.tx.data() + (i - 1) * UMODBUS_TCP_MASTER_REQUEST_SIZE, response));
+	}
+
+	ASSERT_TRUE(master.poll());
+	ASSERT_EQ(0, master.failures());
+
+	for(uint16_t i = 0; i < 5; i++) {
+		ASSERT_EQ(UMODBUS_REQUEST_DONE, requests[i].status);
+		ASSERT_EQ((uint16_t)(i * 20 * 0x0101), values[i]);
+	}
+}
+
+TEST_F(uModbusMasterTest, tcpTimeout) {
+	FakeClient client;
+	uint8_t response[UMODBUS_TCP_BUFFER_SIZE];
+
+	registers[0] = { 0, UMODBUS_TYPE_HOLDING_REGISTER, values + 0 };
+	registers[1] = { 100, UMODBUS_TYPE_HOLDING_REGISTER, values + 1 };
+
+	umodbus::uModbusTcpMaster master(registers, 2, requests, 8, 0);
+	master.begin(&client, 0x21, 100);
+
+	ASSERT_FALSE(master.poll());
+	std::vector<uint8_t> sent = client.tx;
+	client.tx.clear();
+	client.push(response, answer(sent.data(), response));
+	ASSERT_FALSE(master.poll());
+
+	mock_micros() += 200000;
+
+	ASSERT_TRUE(master.poll());
+	ASSERT_EQ(1, master.failures());
+	ASSERT_EQ(UMODBUS_REQUEST_DONE, requests[0].status);
+	ASSERT_EQ(UMODBUS_REQUEST_FAILED, requests[1].status);
+
+	// the late answer belongs to the abandoned cycle and is ignored.
+	ASSERT_FALSE(master.poll());
+	client.push(response, answer(sent.data() + UMODBUS_TCP_MASTER_REQUEST_SIZE, response));
+	ASSERT_FALSE(master.poll());
+	ASSERT_EQ(UMODBUS_REQUEST_PENDING, requests[1].status);
+	ASSERT_EQ(0, values[1]);
+}
@@ -0,0 +1,73 @@
+/*
+Copyright 2020 Jerson Leonardo Huerfano Romero
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <gtest/gtest.h>
+
+#include "umodbus.h"
+#include "umodbus_mbap.h"
+
+using namespace testing;
+
+// read holding registers 0x0010, count 2, transaction 0x0102, unit 0x21.
+static const uint8_t frame[] = { 0x01, 0x02, 0x00, 0x00, 0x00, 0x06, 0x21, 0x03, 0x00, 0x10, 0x00, 0x02 };
+
+TEST(uModbusMbapTest, incompleteHeader) {
+	for(size_t i = 0; i < UMODBUS_MBAP_SIZE; i++) {
+		ASSERT_EQ(UMODBUS_MBAP_INCOMPLETE, umodbus::mbap_frame_size(frame, i));
+	}
+}
+
+TEST(uModbusMbapTest, incompletePdu) {
+	for(size_t i = UMODBUS_MBAP_SIZE; i < sizeof(frame); i++) {
+		ASSERT_EQ(UMODBUS_MBAP_INCOMPLETE, umodbus::mbap_frame_size(frame, i));
+	}
+}
+
+TEST(uModbusMbapTest, completeFrame) {
+	uint8_t stream[sizeof(frame) + 3];
+
+	memcpy(stream, frame, sizeof(frame));
+	memcpy(stream + sizeof(frame), frame, 3);
+
+	ASSERT_EQ(sizeof(frame), umodbus::mbap_frame_size(frame, sizeof(frame)));
+	ASSERT_EQ(sizeof(frame), umodbus::mbap_frame_size(stream, sizeof(stream)));
+}
+
+TEST(uModbusMbapTest, invalidHeader) {
+	uint8_t bad_protocol[sizeof(frame)];
+	uint8_t bad_length[sizeof(frame)];
+
+	memcpy(bad_protocol, frame, sizeof(frame));
+	memcpy(bad_length, frame, sizeof(frame));
+	bad_protocol[3] = 0x01;
+	bad_length[4] = 0x01;
+
+	ASSERT_EQ(UMODBUS_MBAP_INVALID, umodbus::mbap_frame_size(bad_protocol, sizeof(frame)));
+	ASSERT_EQ(UMODBUS_MBAP_INVALID, umodbus::mbap_frame_size(bad_length, sizeof(frame)));
+}
+
+TEST(uModbusMbapTest, headerRoundTrip) {
+	umodbus::mbap_header_t header;
+	uint8_t buff[UMODBUS_MBAP_SIZE];
+
+	umodbus::mbap_read_header(frame, header);
+	ASSERT_EQ(0x0102, header.transaction_identifier);
+	ASSERT_EQ(0, header.protocol_id);
+	ASSERT_EQ(6, header.length);
+	ASSERT_EQ(0x21, header.unit_id);
+
+	umodbus::mbap_write_header(buff, header);
+	ASSERT_EQ(0, memcmp(buff, frame, UMODBUS_MBAP_SIZE));
+}
@@ -0,0 +1,195 @@
+/*
+Copyright 2020 Jerson Leonardo Huerfano Romero
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <gtest/gtest.h>
+#include <vector>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include "umodbus.h"
+#include "umodbus_posix.h"
+
+using namespace testing;
+
+// read holding register 0x0001, count 1.
+static const uint8_t request[] = { 0x00, 0x07, 0x00, 0x00, 0x00, 0x06, 0x21, 0x03, 0x00, 0x01, 0x00, 0x01 };
+
+class uModbusPosixServerTest: public testing::Test {
+public:
+	uint16_t values[4];
+	umodbus::register_t registers[1];
+	umodbus::uModbusPosixServer server;
+
+	uModbusPosixServerTest() : server(0x21, registers, 0) {
+		for(uint16_t i = 0; i < 4; i++) {
+			values[i] = 0x3300 + i;
+		}
+		registers[0] = { 0, UMODBUS_TYPE_HOLDING_REGISTER, values, 4 };
+		server.set_table(UMODBUS_TABLE_HOLDING_REGISTER, registers, 1);
+	}
+
+	int connect_client() {
+		struct sockaddr_in addr;
+		int fd = socket(AF_INET, SOCK_STREAM, 0);
+
+		memset(&addr, 0, sizeof(addr));
+		addr.sin_family = AF_INET;
+		addr.sin_port = htons(server.get_port());
+		inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+
+		if(connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+			close(fd);
+			return -1;
+		}
+
+		fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+		return fd;
+	}
+
+	// polls the server until the client received len bytes or a second passed.
+	std::vector<uint8_t> receive(const int & fd, const size_t & len) {
+		std::vector<uint8_t> data;
+		uint8_t buff[512];
+
+		for(int i = 0; i < 1000 && data.size() < len; i++) {
+			server.poll(1);
+			ssize_t size = recv(fd, buff, sizeof(buff), 0);
+			if(size > 0) {
+				data.insert(data.end(), buff, buff + size);
+			}
+		}
+
+		return data;
+	}
+
+	// polls the server until the client reads end of stream, or a second passed.
+	bool closed_by_server(const int & fd) {
+		uint8_t buff[512];
+
+		for(int i = 0; i < 1000; i++) {
+			server.poll(1);
+			if(recv(fd, buff, sizeof(buff), 0) == 0) {
+				return true;
+			}
+		}
+
+		return false;
+	}
+};
+
+TEST_F(uModbusPosixServerTest, answerRequest) {
+	ASSERT_TRUE(server.listen(0, "127.0.0.1"));
+	int fd = connect_client();
+	ASSERT_GE(fd, 0);
+
+	ASSERT_EQ(sizeof(request), (size_t)write(fd, request, sizeof(request)));
+	std::vector<uint8_t> response = receive(fd, 11);
+
+	const uint8_t expected[] = { 0x00, 0x07, 0x00, 0x00, 0x00, 0x05, 0x21, 0x03, 0x02, 0x33, 0x01 };
+	ASSERT_EQ(std::vector<uint8_t>(expected, expected + sizeof(expected)), response);
+	ASSERT_EQ(1, server.connections());
+	close(fd);
+}
+
+TEST_F(uModbusPosixServerTest, answerPipelinedRequestsOnManyConnections) {
+	const size_t clients = 32;
+	const size_t depth = 16;
+	int fds[clients];
+
+	ASSERT_TRUE(server.listen(0, "127.0.0.1"));
+
+	for(size_t c = 0; c < clients; c++) {
+		std::vector<uint8_t> frames;
+
+		fds[c] = connect_client();
+		ASSERT_GE(fds[c], 0);
+
+		for(uint8_t i = 0; i < depth; i++) {
+			frames.insert(frames.end(), request, request + sizeof(request));
+			frames[frames.size() - sizeof(request) + 1] = i;
+		}
+
+		ASSERT_EQ(frames.size(), (size_t)write(fds[c], frames.data(), frames.size()));
+	}
+
+	for(size_t c = 0; c < clients; c++) {
+		std::vector<uint8_t> response = receive(fds[c], depth * 11);
+
+		ASSERT_EQ(depth * 11, response.size());
+		for(uint8_t i = 0; i < depth; i++) {
+			ASSERT_EQ(i, response[i * 11 + 1]);
+			ASSERT_EQ(0x01, response[i * 11 + 10]);
+		}
+	}
+
+	ASSERT_EQ(clients, server.connections());
+
+	for(size_t c = 0; c < clients; c++) {
+		close(fds[c]);
+	}
+
+	for(int i = 0; i < 100 && server.connections() > 0; i++) {
+		server.poll(1);
+	}
+	ASSERT_EQ(0, server.connections());
+}
+
+TEST_F(uModbusPosixServerTest, dropInvalidStream) {
+	uint8_t bad[sizeof(request)];
+
+	memcpy(bad, request, sizeof(request));
+	bad[2] = 0x01;
+
+	ASSERT_TRUE(server.listen(0, "127.0.0.1"));
+	int fd = connect_client();
+	ASSERT_GE(fd, 0);
+	ASSERT_EQ(sizeof(bad), (size_t)write(fd, bad, sizeof(bad)));
+
+	ASSERT_TRUE(closed_by_server(fd));
+	ASSERT_EQ(0, server.connections());
+	close(fd);
+}
+
+TEST_F(uModbusPosixServerTest, dropInvalidStreamAfterFullOutput) {
+	uint16_t block[125];
+	std::vector<uint8_t> frames;
+	// 16 responses of 259 bytes leave less than a frame of output space.
+	const uint8_t large[] = { 0x00, 0x01, 0x00, 0x00, 0x00, 0x06, 0x21, 0x03, 0x00, 0x00, 0x00, 0x7D };
+
+	memset(block, 0, sizeof(block));
+	registers[0] = { 0, UMODBUS_TYPE_HOLDING_REGISTER, block, 125 };
+	server.set_table(UMODBUS_TABLE_HOLDING_REGISTER, registers, 1);
+
+	for(size_t i = 0; i < 16; i++) {
+		frames.insert(frames.end(), large, large + sizeof(large));
+	}
+	frames.insert(frames.end(), request, request + sizeof(request));
+	frames[frames.size() - sizeof(request) + 2] = 0x01;
+
+	ASSERT_TRUE(server.listen(0, "127.0.0.1"));
+	int fd = connect_client();
+	ASSERT_GE(fd, 0);
+	ASSERT_EQ(frames.size(), (size_t)write(fd, frames.data(), frames.size()));
+	ASSERT_EQ(16 * 259, receive(fd, 16 * 259).size());
+
+	// the client sends nothing more, the bad header alone has to close the connection.
+	ASSERT_TRUE(closed_by_server(fd));
+	ASSERT_EQ(0, server.connections());
+	close(fd);
+}
@@ -0,0 +1,190 @@
+/*
+Copyright 2020 Jerson Leonardo Huerfano Romero
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "umodbus.h"
+#include "umodbus_crc.h"
+#include "umodbus_rtu.h"
+
+using namespace testing;
+
+class FakeSerial : public Stream {
+public:
+	std::vector<uint8_t> rx;
+	std::vector<uint8_t> tx;
+	size_t writes;
+
+	FakeSerial() : writes(0) { }
+
+	void push(const std::vector<uint8_t> & frame) {
+		rx.insert(rx.end(), frame.begin(), frame.end());
+	}
+
+	virtual int available() {
+		return (int)rx.size();
+	}
+
+	virtual int read() {
+		if(rx.empty()) {
+			return -1;
+		}
+		int val = rx.front();
+		rx.erase(rx.begin());
+		return val;
+	}
+
+	virtual size_t write(uint8_t val) {
+		tx.push_back(val);
+		return 1;
+	}
+
+	virtual size_t write(const uint8_t * buf, size_t size) {
+		tx.insert(tx.end(), buf, buf + size);
+		writes++;
+		return size;
+	}
+};
+
+static std::vector<uint8_t> with_crc(std::vector<uint8_t> frame) {
+	uint16_t crc = umodbus::umodbus_crc16(frame.data(), frame.size());
+	frame.push_back(crc & 0xFF);
+	frame.push_back(crc >> 8);
+	return frame;
+}
+
+class uModbusRtuTest: public testing::Test {
+public:
+	uint16_t values[4];
+	umodbus::register_t registers[1];
+	umodbus::uModbusRtu rtu;
+	FakeSerial serial;
+
+	uModbusRtuTest() : rtu(0x11, registers, 0) {
+		for(uint16_t i = 0; i < 4; i++) {
+			values[i] = 0x2200 + i;
+		}
+		registers[0] = { 0, UMODBUS_TYPE_HOLDING_REGISTER, values, 4 };
+		rtu.set_table(UMODBUS_TABLE_HOLDING_REGISTER, registers, 1);
+		rtu.begin(&serial, 115200);
+		mock_micros() = 1000;
+	}
+
+	void idle(const unsigned long & us) {
+		mock_micros() += us;
+		rtu.poll();
+	}
+};
+
+TEST(uModbusCrcTest, knownVector) {
+	const uint8_t frame[] = { 0x01, 0x03, 0x00, 0x00, 0x00, 0x0A, 0xC5, 0xCD };
+
+	ASSERT_EQ(0xCDC5, umodbus::umodbus_crc16(frame, 6));
+	ASSERT_EQ(0, umodbus::umodbus_crc16(frame, sizeof(frame)));
+}
+
+TEST_F(uModbusRtuTest, frameTimeout) {
+	ASSERT_EQ(1750, rtu.get_frame_timeout());
+	rtu.begin(&serial, 9600);
+	ASSERT_EQ(4010, rtu.get_frame_timeout());
+}
+
+TEST_F(uModbusRtuTest, answerAfterSilence) {
+	serial.push(with_crc({ 0x11, 0x03, 0x00, 0x01, 0x00, 0x02 }));
+
+	idle(0);
+	idle(1000);
+	ASSERT_EQ(0, serial.writes);
+
+	idle(800);
+	ASSERT_EQ(1, serial.writes);
+	ASSERT_EQ(with_crc({ 0x11, 0x03, 0x04, 0x22, 0x01, 0x22, 0x02 }), serial.tx);
+}
+
+TEST_F(uModbusRtuTest, frameSplitAcrossPolls) {
+	std::vector<uint8_t> frame = with_crc({ 0x11, 0x06, 0x00, 0x03, 0x12, 0x34 });
+
+	serial.push(std::vector<uint8_t>(frame.begin(), frame.begin() + 3));
+	idle(0);
+	serial.push(std::vector<uint8_t>(frame.begin() + 3, frame.end()));
+	idle(500);
+	idle(1750);
+
+	ASSERT_EQ(0x1234, values[3]);
+	ASSERT_EQ(frame, serial.tx);
+}
+
+TEST_F(uModbusRtuTest, ignoreOtherUnit) {
+	serial.push(with_crc({ 0x12, 0x03, 0x00, 0x01, 0x00, 0x02 }));
+
+	idle(0);
+	idle(2000);
+	ASSERT_EQ(0, serial.writes);
+}
+
+TEST_F(uModbusRtuTest, dropCorruptFrame) {
+	std::vector<uint8_t> frame = with_crc({ 0x11, 0x06, 0x00, 0x03, 0x12, 0x34 });
+	frame[4] ^= 0x01;
+	serial.push(frame);
+
+	idle(0);
+	idle(2000);
+	ASSERT_EQ(0, serial.writes);
+	ASSERT_EQ(0x2203, values[3]);
+}
+
+TEST_F(uModbusRtuTest, broadcastWithoutReply) {
+	serial.push(with_crc({ 0x00, 0x06, 0x00, 0x00, 0x55, 0xAA }));
+
+	idle(0);
+	idle(2000);
+	ASSERT_EQ(0, serial.writes);
+	ASSERT_EQ(0x55AA, values[0]);
+}
+
+#ifdef UMODBUS_STATS
+TEST_F(uModbusRtuTest, diagnosticCounters) {
+	std::vector<uint8_t> corrupt = with_crc({ 0x11, 0x06, 0x00, 0x03, 0x12, 0x34 });
+	corrupt[4] ^= 0x01;
+
+	serial.push(corrupt);
+	idle(0);
+	idle(2000);
+	serial.push(with_crc({ 0x12, 0x03, 0x00, 0x01, 0x00, 0x02 }));
+	idle(0);
+	idle(2000);
+	serial.push(with_crc({ 0x00, 0x06, 0x00, 0x00, 0x55, 0xAA }));
+	idle(0);
+	idle(2000);
+
+	serial.push(with_crc({ 0x11, 0x08, 0x00, 0x0B, 0x00, 0x00 }));
+	idle(0);
+	idle(2000);
+	ASSERT_EQ(with_crc({ 0x11, 0x08, 0x00, 0x0B, 0x00, 0x02 }), serial.tx);
+
+	serial.tx.clear();
+	serial.push(with_crc({ 0x11, 0x08, 0x00, 0x0C, 0x00, 0x00 }));
+	idle(0);
+	idle(2000);
+	ASSERT_EQ(with_crc({ 0x11, 0x08, 0x00, 0x0C, 0x00, 0x01 }), serial.tx);
+
+	serial.tx.clear();
+	serial.push(with_crc({ 0x11, 0x08, 0x00, 0x0F, 0x00, 0x00 }));
+	idle(0);
+	idle(2000);
+	ASSERT_EQ(with_crc({ 0x11, 0x08, 0x00, 0x0F, 0x00, 0x01 }), serial.tx);
+}
+#endif
@@ -0,0 +1,204 @@
+/*
+Copyright 2020 Jerson Leonardo Huerfano Romero
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "umodbus.h"
+#include "umodbus_tcp.h"
+#include "fakeclient.h"
+
+using namespace testing;
+
+// read holding register 0x0001, count 1.
+static const uint8_t request[] = { 0x00, 0x07, 0x00, 0x00, 0x00, 0x06, 0x21, 0x03, 0x00, 0x01, 0x00, 0x01 };
+
+class uModbusTcpServerTest: public testing::Test {
+public:
+	uint16_t values[4];
+	umodbus::register_t registers[1];
+	umodbus::tcp_slot_t slots[3];
+	umodbus::uModbusTcpServer server;
+
+	uModbusTcpServerTest() : server(0x21, registers, 0, slots, 3) {
+		for(uint16_t i = 0; i < 4; i++) {
+			values[i] = 0x1100 + i;
+		}
+		registers[0] = { 0, UMODBUS_TYPE_HOLDING_REGISTER, values, 4 };
+		server.set_table(UMODBUS_TABLE_HOLDING_REGISTER, registers, 1);
+	}
+};
+
+TEST_F(uModbusTcpServerTest, acceptUpToSlotCount) {
+	FakeClient clients[4];
+
+	ASSERT_TRUE(server.accept(clients + 0));
+	ASSERT_TRUE(server.accept(clients + 1));
+	ASSERT_TRUE(server.accept(clients + 0));
+	ASSERT_TRUE(server.accept(clients + 2));
+	ASSERT_FALSE(server.accept(clients + 3));
+	ASSERT_EQ(3, server.connections());
+
+	server.disconnect(clients + 1);
+	ASSERT_EQ(2, server.connections());
+	ASSERT_TRUE(server.accept(clients + 3));
+}
+
+TEST_F(uModbusTcpServerTest, serveEverySlotInOnePoll) {
+	FakeClient clients[3];
+
+	for(size_t i = 0; i < 3; i++) {
+		server.accept(clients + i);
+		clients[i].push(request, sizeof(request));
+	}
+
+	server.poll();
+
+	for(size_t i = 0; i < 3; i++) {
+		const uint8_t expected[] = { 0x00, 0x07, 0x00, 0x00, 0x00, 0x05, 0x21, 0x03, 0x02, 0x11, 0x01 };
+		ASSERT_EQ(std::vector<uint8_t>(expected, expected + sizeof(expected)), clients[i].tx);
+	}
+}
+
+TEST_F(uModbusTcpServerTest, keepPartialFramePerSlot) {
+	FakeClient a;
+	FakeClient b;
+
+	server.accept(&a);
+	server.accept(&b);
+	a.push(request, 5);
+	b.push(request, sizeof(request));
+
+	server.poll();
+	ASSERT_EQ(0, a.writes);
+	ASSERT_EQ(1, b.writes);
+
+	a.push(request + 5, sizeof(request) - 5);
+	server.poll();
+	ASSERT_EQ(1, a.writes);
+	ASSERT_EQ(1, b.writes);
+}
+
+TEST_F(uModbusTcpServerTest, dropInvalidStream) {
+	FakeClient a;
+	uint8_t bad[sizeof(request)];
+
+	memcpy(bad, request, sizeof(request));
+	bad[2] = 0x01;
+	server.accept(&a);
+	a.push(bad, sizeof(bad));
+
+	server.poll();
+	ASSERT_FALSE(a.open);
+	ASSERT_EQ(0, server.connections());
+}
+
+TEST_F(uModbusTcpServerTest, answerPipelinedRequests) {
+	FakeClient a;
+
+	server.accept(&a);
+	for(uint8_t i = 0; i < 16; i++) {
+		uint8_t frame[sizeof(request)];
+		memcpy(frame, request, sizeof(request));
+		frame[1] = i;
+		frame[9] = i % 4;
+		a.push(frame, sizeof(frame));
+	}
+
+	server.poll();
+
+	ASSERT_EQ(16 * 11, a.tx.size());
+	ASSERT_LT(a.writes, 16);
+	for(uint8_t i = 0; i < 16; i++) {
+		const uint8_t * response = a.tx.data() + i * 11;
+		ASSERT_EQ(i, response[1]);
+		ASSERT_EQ(5, response[5]);
+		ASSERT_EQ(0x11, response[9]);
+		ASSERT_EQ(i % 4, response[10]);
+	}
+}
+
+TEST_F(uModbusTcpServerTest, limitRequestsPerTurn) {
+	FakeClient a;
+	FakeClient b;
+
+	server.accept(&a);
+	server.accept(&b);
+	for(uint8_t i = 0; i < UMODBUS_TCP_PIPELINE_DEPTH + 2; i++) {
+		a.push(request, sizeof(request));
+	}
+	b.push(request, sizeof(request));
+
+	server.poll();
+	ASSERT_EQ(UMODBUS_TCP_PIPELINE_DEPTH * 11, a.tx.size());
+	ASSERT_EQ(11, b.tx.size());
+
+	server.poll();
+	ASSERT_EQ((UMODBUS_TCP_PIPELINE_DEPTH + 2) * 11, a.tx.size());
+}
+
+TEST_F(uModbusTcpServerTest, answerFullSizeRead) {
+	FakeClient a;
+	uint16_t block[125];
+	const uint8_t read[] = { 0x00, 0x01, 0x00, 0x00, 0x00, 0x06, 0x21, 0x04, 0x00, 0x00, 0x00, 0x7D };
+
+	for(uint16_t i = 0; i < 125; i++) {
+		block[i] = i;
+	}
+	registers[0] = { 0, UMODBUS_TYPE_INPUT_REGISTER, block, 125 };
+	server.set_table(UMODBUS_TABLE_INPUT_REGISTER, registers, 1);
+	server.accept(&a);
+	a.push(read, sizeof(read));
+
+	server.poll();
+
+	ASSERT_EQ(UMODBUS_MBAP_SIZE + 2 + 250, a.tx.size());
+	ASSERT_EQ(253, umodbus::umodbus_load_u16(a.tx.data() + 4));
+	ASSERT_EQ(250, a.tx[8]);
+	ASSERT_EQ(124, umodbus::umodbus_load_u16(a.tx.data() + a.tx.size() - 2));
+}
+
+static size_t write_calls = 0;
+static std::vector<umodbus::write_range_t> written;
+
+static void record_writes(void * context, const umodbus::write_range_t * ranges, const size_t & count) {
+	write_calls++;
+	written.assign(ranges, ranges + count);
+}
+
+TEST_F(uModbusTcpServerTest, coalescePipelinedWrites) {
+	FakeClient a;
+
+	server.set_write_callback(record_writes);
+	server.accept(&a);
+
+	// writes to 3, 1 and 2 arrive together and are reported as one range.
+	for(uint8_t i = 0; i < 3; i++) {
+		const uint8_t addresses[] = { 3, 1, 2 };
+		uint8_t frame[] = { 0x00, i, 0x00, 0x00, 0x00, 0x06, 0x21, 0x06, 0x00, addresses[i], 0x00, i };
+		a.push(frame, sizeof(frame));
+	}
+
+	server.poll();
+
+	ASSERT_EQ(1, write_calls);
+	ASSERT_EQ(1, written.size());
+	ASSERT_EQ(UMODBUS_TABLE_HOLDING_REGISTER, written[0].table);
+	ASSERT_EQ(1, written[0].address);
+	ASSERT_EQ(3, written[0].count);
+
+	server.poll();
+	ASSERT_EQ(1, write_calls);
+}
@@ -27,7 +27,10 @@ limitations under the License.
 
 #include "umodbus.h"
 #include "umodbus_envelop.h"
+#include "umodbus_fifo.h"
+#include "umodbus_bank.h"
 #include "string.h"
+#include <vector>
 
 using namespace testing;
 
@@ -63,6 +66,7 @@ public:
 			};
 			this->set_register(i, 0);
 		}
+		envelop.enveloped_set_registers(registers, 10);
 	}
 
 	void reset_registers() {
@@ -86,7 +90,7 @@ TEST_F(uModbusCoilTest, searchExistingAddress) {
 	uint16_t address = 4;
 
 	this->configure_registers(UMODBUS_TYPE_COIL);
-	size_t index = this->envelop.enveloped_binary_search(address);
+	size_t index = this->envelop.enveloped_find_register(UMODBUS_TABLE_COIL, address);
 
 	ASSERT_EQ(address, index);
 }
@@ -95,11 +99,41 @@ TEST_F(uModbusCoilTest, searchNonExistingAddress) {
 	uint16_t address = 14;
 
 	this->configure_registers(UMODBUS_TYPE_COIL);
-	size_t index = this->envelop.enveloped_binary_search(address);
+	size_t index = this->envelop.enveloped_find_register(UMODBUS_TABLE_COIL, address);
 
 	ASSERT_EQ(SIZE_MAX, index);
 }
 
+TEST_F(uModbusCoilTest, searchSeparatesTables) {
+	registers[0] = { 0, UMODBUS_TYPE_HOLDING_REGISTER, register_value_buf + 0 };
+	registers[1] = { 0, UMODBUS_TYPE_COIL, register_value_buf + 1 };
+	registers[2] = { 1, UMODBUS_TYPE_HOLDING_REGISTER, register_value_buf + 2 };
+	registers[3] = { 0, UMODBUS_TYPE_DISCRETE_INPUT, register_value_buf + 3 };
+	this->envelop.enveloped_set_registers(registers, 4);
+
+	size_t coil = this->envelop.enveloped_find_register(UMODBUS_TABLE_COIL, 0);
+	size_t input = this->envelop.enveloped_find_register(UMODBUS_TABLE_DISCRETE_INPUT, 0);
+	size_t holding = this->envelop.enveloped_find_register(UMODBUS_TABLE_HOLDING_REGISTER, 1);
+
+	ASSERT_EQ(0, coil);
+	ASSERT_EQ(0, input);
+	ASSERT_EQ(1, holding);
+	ASSERT_EQ(SIZE_MAX, this->envelop.enveloped_find_register(UMODBUS_TABLE_INPUT_REGISTER, 0));
+	ASSERT_EQ(register_value_buf + 1, registers[coil].ptr);
+}
+
+TEST_F(uModbusCoilTest, searchSparseTable) {
+	for(size_t i = 0; i < 10; i++) {
+		registers[i] = { (uint16_t)(i < 5 ? i : i + 10), UMODBUS_TYPE_HOLDING_REGISTER, register_value_buf + i };
+	}
+	this->envelop.enveloped_set_registers(registers, 10);
+
+	ASSERT_EQ(6, this->envelop.enveloped_find_register(UMODBUS_TABLE_HOLDING_REGISTER, 16));
+	ASSERT_EQ(SIZE_MAX, this->envelop.enveloped_find_register(UMODBUS_TABLE_HOLDING_REGISTER, 7));
+	ASSERT_EQ(2, this->envelop.enveloped_find_range(UMODBUS_TABLE_HOLDING_REGISTER, 2, 3));
+	ASSERT_EQ(SIZE_MAX, this->envelop.enveloped_find_range(UMODBUS_TABLE_HOLDING_REGISTER, 2, 4));
+}
+
 TEST_F(uModbusCoilTest, readSingleOffCoil) {
 	ArrayStream is({ input, 50 });
 	ArrayStream os({ output, 50 });
@@ -416,3 +450,967 @@ TEST_F(uModbusCoilTest, writeMultipleRegisters) {
 		ASSERT_EQ(v, *(registers[address + i].ptr));
 	}
 }
+
+TEST_F(uModbusCoilTest, readRegisterBlocks) {
+	ArrayStream is({ input, 50 });
+	ArrayStream os({ output, 50 });
+	uint16_t block[8] = { 0x1001, 0x1002, 0x1003, 0x1004, 0x1005, 0x1006, 0x1007, 0x1008 };
+	read_register_packet_t packet = { 12, 6 };
+	uint8_t fnc;
+	uint8_t count;
+	uint16_t value;
+
+	registers[0] = { 10, UMODBUS_TYPE_HOLDING_REGISTER, block, 5 };
+	registers[1] = { 15, UMODBUS_TYPE_HOLDING_REGISTER, block + 5, 3 };
+	this->envelop.enveloped_set_registers(registers, 2);
+	write_packet(&is, packet);
+
+	this->envelop.enveloped_read_as_register(UMODBUS_FNCODE_RD_M_HOLDING_REG);
+
+	fnc = os.read();
+	ASSERT_EQ(fnc, UMODBUS_FNCODE_RD_M_HOLDING_REG);
+	count = os.read();
+	ASSERT_EQ(count, 12);
+
+	for(size_t i = 0; i < 6; i++) {
+		os.read(value);
+		ASSERT_EQ(block[2 + i], value);
+	}
+}
+
+TEST_F(uModbusCoilTest, readRegisterBlocksWithGap) {
+	ArrayStream is({ input, 50 });
+	ArrayStream os({ output, 50 });
+	uint16_t block[8] = { 0 };
+	read_register_packet_t packet = { 12, 6 };
+
+	registers[0] = { 10, UMODBUS_TYPE_HOLDING_REGISTER, block, 5 };
+	registers[1] = { 16, UMODBUS_TYPE_HOLDING_REGISTER, block + 5, 3 };
+	this->envelop.enveloped_set_registers(registers, 2);
+	write_packet(&is, packet);
+
+	this->envelop.enveloped_read_as_register(UMODBUS_FNCODE_RD_M_HOLDING_REG);
+
+	ASSERT_EQ(UMODBUS_FNCODE_RD_M_HOLDING_REG + 0x80, os.read());
+	ASSERT_EQ(0x02, os.read());
+}
+
+TEST_F(uModbusCoilTest, writeRegisterBlock) {
+	ArrayStream is({ input, 50 });
+	ArrayStream os({ output, 50 });
+	uint16_t block[10] = { 0 };
+	write_multiple_register_packet_t packet = { 103, 4, 8 };
+	uint8_t fnc;
+	uint16_t address;
+	uint16_t outputCount;
+
+	registers[0] = { 100, UMODBUS_TYPE_HOLDING_REGISTER, block, 10 };
+	this->envelop.enveloped_set_registers(registers, 1);
+	write_packet(&is, packet);
+	for(uint16_t i = 0; i < 4; i++) {
+		is.write((uint16_t)(0xA0B0 + i));
+	}
+
+	this->envelop.enveloped_write_multiple_registers(UMODBUS_FNCODE_WR_M_HOLDING_REGS);
+
+	fnc = os.read();
+	ASSERT_EQ(fnc, UMODBUS_FNCODE_WR_M_HOLDING_REGS);
+	os.read(address);
+	ASSERT_EQ(103, address);
+	os.read(outputCount);
+	ASSERT_EQ(4, outputCount);
+
+	ASSERT_EQ(0, block[2]);
+	for(uint16_t i = 0; i < 4; i++) {
+		ASSERT_EQ(0xA0B0 + i, block[3 + i]);
+	}
+	ASSERT_EQ(0, block[7]);
+}
+
+TEST_F(uModbusCoilTest, processRequestFrame) {
+	ArrayStream is({ input, 50 });
+	ArrayStream os({ output, 50 });
+	read_register_packet_t packet = { 3, 2 };
+	uint16_t value;
+
+	this->configure_registers(UMODBUS_TYPE_HOLDING_REGISTER);
+	this->set_register(3, 0x1234);
+	this->set_register(4, 0x5678);
+	is.write((uint8_t)UMODBUS_FNCODE_RD_M_HOLDING_REG);
+	write_packet(&is, packet);
+
+	ASSERT_EQ(6, this->envelop.enveloped_process(5));
+
+	ASSERT_EQ(UMODBUS_FNCODE_RD_M_HOLDING_REG, os.read());
+	ASSERT_EQ(4, os.read());
+	os.read(value);
+	ASSERT_EQ(0x1234, value);
+	os.read(value);
+	ASSERT_EQ(0x5678, value);
+}
+
+TEST_F(uModbusCoilTest, processTruncatedFrame) {
+	ArrayStream is({ input, 50 });
+	ArrayStream os({ output, 50 });
+	write_coil_packet_t packet = { 4, 0x2255 };
+
+	this->configure_registers(UMODBUS_TYPE_HOLDING_REGISTER);
+	is.write((uint8_t)UMODBUS_FNCODE_WR_S_HOLDING_REG);
+	write_packet(&is, packet);
+
+	ASSERT_EQ(2, this->envelop.enveloped_process(4));
+
+	ASSERT_EQ(UMODBUS_FNCODE_WR_S_HOLDING_REG + 0x80, os.read());
+	ASSERT_EQ(0x03, os.read());
+	ASSERT_EQ(0, *(registers[4].ptr));
+}
+
+TEST_F(uModbusCoilTest, responseOverflow) {
+	ArrayStream is({ input, 50 });
+	ArrayStream os({ output, 50 });
+	uint16_t block[125] = { 0 };
+	read_register_packet_t packet = { 0, 125 };
+
+	registers[0] = { 0, UMODBUS_TYPE_INPUT_REGISTER, block, 125 };
+	this->envelop.enveloped_set_registers(registers, 1);
+	is.write((uint8_t)UMODBUS_FNCODE_RD_M_INPUT_REG);
+	write_packet(&is, packet);
+
+	ASSERT_EQ(2, this->envelop.enveloped_process(5));
+
+	ASSERT_EQ(UMODBUS_FNCODE_RD_M_INPUT_REG + 0x80, os.read());
+	ASSERT_EQ(0x04, os.read());
+}
+
+TEST_F(uModbusCoilTest, readMaximumRegisters) {
+	uint8_t response[UMODBUS_MAX_PDU_SIZE];
+	uint16_t block[125];
+	read_register_packet_t packet = { 0, 125 };
+	ArrayStream is({ input, 50 });
+	ArrayStream os({ response, sizeof(response) });
+	uint16_t value;
+
+	for(uint16_t i = 0; i < 125; i++) {
+		block[i] = 0x4000 + i;
+	}
+	registers[0] = { 0, UMODBUS_TYPE_INPUT_REGISTER, block, 125 };
+	this->envelop.enveloped_set_registers(registers, 1);
+	(this->envelop.get_write_buf())->ptr = response;
+	(this->envelop.get_write_buf())->size = sizeof(response);
+	is.write((uint8_t)UMODBUS_FNCODE_RD_M_INPUT_REG);
+	write_packet(&is, packet);
+
+	ASSERT_EQ(252, this->envelop.enveloped_process(5));
+
+	ASSERT_EQ(UMODBUS_FNCODE_RD_M_INPUT_REG, os.read());
+	ASSERT_EQ(250, os.read());
+	for(uint16_t i = 0; i < 125; i++) {
+		os.read(value);
+		ASSERT_EQ(0x4000 + i, value);
+	}
+}
+
+TEST_F(uModbusCoilTest, copyBits) {
+	const uint8_t src[] = { 0xA5, 0x3C, 0xF0, 0x0F };
+	uint8_t dst[4];
+
+	for(size_t src_bit = 0; src_bit < 8; src_bit++) {
+		for(size_t dst_bit = 0; dst_bit < 8; dst_bit++) {
+			memset(dst, 0x55, sizeof(dst));
+			umodbus::umodbus_copy_bits(dst, dst_bit, src, src_bit, 20);
+
+			for(size_t i = 0; i < 32; i++) {
+				uint8_t expected = (i >= dst_bit && i < dst_bit + 20) 
+					? ((src[(src_bit + i - dst_bit) / 8] >> ((src_bit + i - dst_bit) % 8)) & 1)
+					: ((0x55 >> (i % 8)) & 1);
+				ASSERT_EQ(expected, (dst[i / 8] >> (i % 8)) & 1);
+			}
+		}
+	}
+}
+
+TEST_F(uModbusCoilTest, readCoilBank) {
+	ArrayStream is({ input, 50 });
+	ArrayStream os({ output, 50 });
+	uint8_t bank[3] = { 0xF0, 0xAA, 0x0F };
+	read_coil_packet_t packet = { 0, 13 };
+
+	registers[0] = { 0, UMODBUS_TYPE_COIL, register_value_buf, 1 };
+	registers[1] = { 1, UMODBUS_TYPE_COIL_BITS, UMODBUS_BITS_PTROF(bank), 24 };
+	register_value_buf[0] = UMODBUS_COIL_ON;
+	this->envelop.enveloped_set_registers(registers, 2);
+	write_packet(&is, packet);
+
+	this->envelop.enveloped_read_as_byte(UMODBUS_FNCODE_RD_M_COIL);
+
+	// coil 0 from the word entry, coils 1..12 from bank bits 0..11.
+	ASSERT_EQ(UMODBUS_FNCODE_RD_M_COIL, os.read());
+	ASSERT_EQ(2, os.read());
+	ASSERT_EQ(0xE1, os.read());
+	ASSERT_EQ(0x15, os.read());
+}
+
+TEST_F(uModbusCoilTest, writeCoilBank) {
+	ArrayStream is({ input, 50 });
+	ArrayStream os({ output, 50 });
+	uint8_t bank[3] = { 0x00, 0x00, 0x00 };
+	write_multiple_coil_packet_t packet = { 105, 10, 2 };
+	uint8_t val[] = { 0xFF, 0x02 };
+
+	registers[0] = { 100, UMODBUS_TYPE_COIL_BITS, UMODBUS_BITS_PTROF(bank), 24 };
+	this->envelop.enveloped_set_registers(registers, 1);
+	write_packet(&is, packet);
+	is.write(val, 2);
+
+	this->envelop.enveloped_write_multiple_as_byte(UMODBUS_FNCODE_WR_M_COIL);
+
+	ASSERT_EQ(UMODBUS_FNCODE_WR_M_COIL, os.read());
+	ASSERT_EQ(0xE0, bank[0]);
+	ASSERT_EQ(0x5F, bank[1]);
+	ASSERT_EQ(0x00, bank[2]);
+}
+
+TEST_F(uModbusCoilTest, writeSingleCoilBank) {
+	ArrayStream is({ input, 50 });
+	ArrayStream os({ output, 50 });
+	uint8_t bank[2] = { 0xFF, 0x00 };
+	write_coil_packet_t off = { 3, UMODBUS_COIL_OFF };
+	write_coil_packet_t on = { 9, UMODBUS_COIL_ON };
+
+	registers[0] = { 0, UMODBUS_TYPE_COIL_BITS, UMODBUS_BITS_PTROF(bank), 16 };
+	this->envelop.enveloped_set_registers(registers, 1);
+
+	write_packet(&is, off);
+	this->envelop.enveloped_write_single_as_byte(UMODBUS_FNCODE_WR_S_COIL);
+	is.wseek(0);
+	write_packet(&is, on);
+	this->envelop.enveloped_write_single_as_byte(UMODBUS_FNCODE_WR_S_COIL);
+
+	ASSERT_EQ(0xF7, bank[0]);
+	ASSERT_EQ(0x02, bank[1]);
+}
+
+TEST_F(uModbusCoilTest, readWriteRegisters) {
+	ArrayStream is({ input, 50 });
+	ArrayStream os({ output, 50 });
+	uint16_t value;
+
+	this->configure_registers(UMODBUS_TYPE_HOLDING_REGISTER);
+	this->set_register(2, 0x1111);
+	this->set_register(3, 0x2222);
+	is.write((uint8_t)UMODBUS_FNCODE_RW_M_REG);
+	is.write((uint16_t)2);
+	is.write((uint16_t)3);
+	is.write((uint16_t)3);
+	is.write((uint16_t)2);
+	is.write((uint8_t)4);
+	is.write((uint16_t)0xAAAA);
+	is.write((uint16_t)0xBBBB);
+
+	ASSERT_EQ(8, this->envelop.enveloped_process(14));
+
+	ASSERT_EQ(UMODBUS_FNCODE_RW_M_REG, os.read());
+	ASSERT_EQ(6, os.read());
+	os.read(value);
+	ASSERT_EQ(0x1111, value);
+	os.read(value);
+	ASSERT_EQ(0xAAAA, value);
+	os.read(value);
+	ASSERT_EQ(0xBBBB, value);
+}
+
+TEST_F(uModbusCoilTest, readWriteRegistersInvalidRange) {
+	ArrayStream is({ input, 50 });
+	ArrayStream os({ output, 50 });
+
+	this->configure_registers(UMODBUS_TYPE_HOLDING_REGISTER);
+	is.write((uint8_t)UMODBUS_FNCODE_RW_M_REG);
+	is.write((uint16_t)8);
+	is.write((uint16_t)3);
+	is.write((uint16_t)0);
+	is.write((uint16_t)1);
+	is.write((uint8_t)2);
+	is.write((uint16_t)0xAAAA);
+
+	ASSERT_EQ(2, this->envelop.enveloped_process(12));
+
+	ASSERT_EQ(UMODBUS_FNCODE_RW_M_REG + 0x80, os.read());
+	ASSERT_EQ(0x02, os.read());
+	ASSERT_EQ(0, *(registers[0].ptr));
+}
+
+TEST_F(uModbusCoilTest, readWriteRegistersBadByteCount) {
+	ArrayStream is({ input, 50 });
+	ArrayStream os({ output, 50 });
+
+	this->configure_registers(UMODBUS_TYPE_HOLDING_REGISTER);
+	is.write((uint8_t)UMODBUS_FNCODE_RW_M_REG);
+	is.write((uint16_t)0);
+	is.write((uint16_t)1);
+	is.write((uint16_t)0);
+	is.write((uint16_t)2);
+	is.write((uint8_t)2);
+	is.write((uint16_t)0xAAAA);
+
+	ASSERT_EQ(2, this->envelop.enveloped_process(12));
+
+	ASSERT_EQ(UMODBUS_FNCODE_RW_M_REG + 0x80, os.read());
+	ASSERT_EQ(0x03, os.read());
+	ASSERT_EQ(0, *(registers[0].ptr));
+}
+
+TEST_F(uModbusCoilTest, maskWriteRegister) {
+	ArrayStream is({ input, 50 });
+	ArrayStream os({ output, 50 });
+	uint16_t value;
+
+	this->configure_registers(UMODBUS_TYPE_HOLDING_REGISTER);
+	this->set_register(4, 0x0012);
+	is.write((uint8_t)UMODBUS_FNCODE_MSK_WR_REG);
+	is.write((uint16_t)4);
+	is.write((uint16_t)0x00F2);
+	is.write((uint16_t)0x0025);
+
+	ASSERT_EQ(7, this->envelop.enveloped_process(7));
+
+	ASSERT_EQ(UMODBUS_FNCODE_MSK_WR_REG, os.read());
+	os.read(value);
+	ASSERT_EQ(4, value);
+	os.read(value);
+	ASSERT_EQ(0x00F2, value);
+	os.read(value);
+	ASSERT_EQ(0x0025, value);
+	ASSERT_EQ(0x0017, *(registers[4].ptr));
+}
+
+TEST_F(uModbusCoilTest, readFifoQueue) {
+	ArrayStream is({ input, 50 });
+	ArrayStream os({ output, 50 });
+	umodbus::umodbus_fifo_t fifo;
+	uint16_t value;
+
+	umodbus::umodbus_fifo_init(&fifo);
+	umodbus::umodbus_fifo_push(&fifo, 0x01B8);
+	umodbus::umodbus_fifo_push(&fifo, 0x1284);
+
+	registers[0] = { 0x04DE, UMODBUS_TYPE_HOLDING_REGISTER_FIFO, UMODBUS_FIFO_PTROF(fifo), 1 };
+	this->envelop.enveloped_set_registers(registers, 1);
+	is.write((uint8_t)UMODBUS_FNCODE_RD_FIFO_QUEUE);
+	is.write((uint16_t)0x04DE);
+
+	ASSERT_EQ(9, this->envelop.enveloped_process(3));
+
+	ASSERT_EQ(UMODBUS_FNCODE_RD_FIFO_QUEUE, os.read());
+	os.read(value);
+	ASSERT_EQ(6, value);
+	os.read(value);
+	ASSERT_EQ(2, value);
+	os.read(value);
+	ASSERT_EQ(0x01B8, value);
+	os.read(value);
+	ASSERT_EQ(0x1284, value);
+	ASSERT_EQ(0, umodbus::umodbus_fifo_count(&fifo));
+}
+
+TEST_F(uModbusCoilTest, readFifoQueueNotAFifo) {
+	ArrayStream is({ input, 50 });
+	ArrayStream os({ output, 50 });
+
+	this->configure_registers(UMODBUS_TYPE_HOLDING_REGISTER);
+	is.write((uint8_t)UMODBUS_FNCODE_RD_FIFO_QUEUE);
+	is.write((uint16_t)2);
+
+	ASSERT_EQ(2, this->envelop.enveloped_process(3));
+
+	ASSERT_EQ(UMODBUS_FNCODE_RD_FIFO_QUEUE + 0x80, os.read());
+	ASSERT_EQ(0x02, os.read());
+}
+
+TEST_F(uModbusCoilTest, readTypedValues) {
+	ArrayStream is({ input, 50 });
+	ArrayStream os({ output, 50 });
+	float factor = 0.24f;
+	uint32_t counter = 0x11223344;
+	uint64_t total = 0x0102030405060708ULL;
+	uint8_t expected[] = { 0x3E, 0x75, 0xC2, 0x8F, 0x33, 0x44, 0x11, 0x22, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08 };
+
+	registers[0] = umodbus::umodbus_bind_value(0, UMODBUS_TYPE_HOLDING_REGISTER, factor);
+	registers[1] = umodbus::umodbus_bind_value<uint32_t, umodbus::umodbus_lsw_first>(2, UMODBUS_TYPE_HOLDING_REGISTER, counter);
+	registers[2] = umodbus::umodbus_bind_value(4, UMODBUS_TYPE_HOLDING_REGISTER, total);
+	this->envelop.enveloped_set_registers(registers, 3);
+	is.write((uint8_t)UMODBUS_FNCODE_RD_M_HOLDING_REG);
+	is.write((uint16_t)0);
+	is.write((uint16_t)8);
+
+	ASSERT_EQ(18, this->envelop.enveloped_process(5));
+
+	ASSERT_EQ(UMODBUS_FNCODE_RD_M_HOLDING_REG, output[0]);
+	ASSERT_EQ(16, output[1]);
+	ASSERT_EQ(0, memcmp(expected, output + 2, sizeof(expected)));
+}
+
+TEST_F(uModbusCoilTest, writeTypedValue) {
+	ArrayStream is({ input, 50 });
+	ArrayStream os({ output, 50 });
+	int32_t setpoint = 0;
+
+	registers[0] = umodbus::umodbus_bind_value(10, UMODBUS_TYPE_HOLDING_REGISTER, setpoint);
+	this->envelop.enveloped_set_registers(registers, 1);
+	is.write((uint8_t)UMODBUS_FNCODE_WR_M_HOLDING_REGS);
+	is.write((uint16_t)10);
+	is.write((uint16_t)2);
+	is.write((uint8_t)4);
+	is.write((uint16_t)0xFFFE);
+	is.write((uint16_t)0x1DC0);
+
+	ASSERT_EQ(5, this->envelop.enveloped_process(10));
+	ASSERT_EQ(-123456, setpoint);
+
+	// a single word only replaces its half of the value.
+	is.wseek(0);
+	is.write((uint8_t)UMODBUS_FNCODE_WR_S_HOLDING_REG);
+	is.write((uint16_t)11);
+	is.write((uint16_t)0x0001);
+
+	ASSERT_EQ(5, this->envelop.enveloped_process(5));
+	ASSERT_EQ((int32_t)0xFFFE0001, setpoint);
+}
+
+TEST_F(uModbusCoilTest, readRegisterBank) {
+	ArrayStream is({ input, 50 });
+	ArrayStream os({ output, 50 });
+	umodbus::umodbus_bank_t bank;
+	uint16_t storage[8];
+	uint16_t cycle[4] = { 0x0A0B, 0x0C0D, 0x0E0F, 0x1011 };
+	uint16_t value;
+
+	umodbus::umodbus_bank_init(&bank, storage, 4);
+	umodbus::umodbus_bank_commit(&bank, cycle);
+	registers[0] = { 20, UMODBUS_TYPE_INPUT_REGISTER_BANK, UMODBUS_BANK_PTROF(bank), 4 };
+	this->envelop.enveloped_set_registers(registers, 1);
+	is.write((uint8_t)UMODBUS_FNCODE_RD_M_INPUT_REG);
+	is.write((uint16_t)21);
+	is.write((uint16_t)2);
+
+	ASSERT_EQ(6, this->envelop.enveloped_process(5));
+
+	ASSERT_EQ(UMODBUS_FNCODE_RD_M_INPUT_REG, os.read());
+	ASSERT_EQ(4, os.read());
+	os.read(value);
+	ASSERT_EQ(0x0C0D, value);
+	os.read(value);
+	ASSERT_EQ(0x0E0F, value);
+}
+
+static uint16_t flash_words[4] = { 0x0102, 0x0304, 0x0506, 0x0708 };
+static uint16_t flash_point = 0x0A0B;
+
+static const umodbus::register_t flash_registers[] UMODBUS_PROGMEM = {
+	{ 0, UMODBUS_TYPE_COIL, &flash_point },
+	{ 10, UMODBUS_TYPE_HOLDING_REGISTER, flash_words, 4 },
+	{ 14, UMODBUS_TYPE_HOLDING_REGISTER, &flash_point },
+};
+
+static const umodbus::register_t unsorted_registers[] UMODBUS_PROGMEM = {
+	{ 10, UMODBUS_TYPE_HOLDING_REGISTER, flash_words, 4 },
+	{ 12, UMODBUS_TYPE_HOLDING_REGISTER, &flash_point },
+};
+
+TEST_F(uModbusCoilTest, flashRegisters) {
+	ArrayStream is({ input, 50 });
+	ArrayStream os({ output, 50 });
+	uint16_t value;
+
+	ASSERT_FALSE(this->envelop.enveloped_set_registers_P(unsorted_registers, 2));
+	ASSERT_EQ(SIZE_MAX, this->envelop.enveloped_find_register(UMODBUS_TABLE_HOLDING_REGISTER, 10));
+
+	ASSERT_TRUE(this->envelop.enveloped_set_registers_P(flash_registers, 3));
+	ASSERT_EQ(0, this->envelop.enveloped_find_range(UMODBUS_TABLE_HOLDING_REGISTER, 12, 3));
+	is.write((uint8_t)UMODBUS_FNCODE_RD_M_HOLDING_REG);
+	is.write((uint16_t)13);
+	is.write((uint16_t)2);
+
+	ASSERT_EQ(6, this->envelop.enveloped_process(5));
+
+	ASSERT_EQ(UMODBUS_FNCODE_RD_M_HOLDING_REG, os.read());
+	ASSERT_EQ(4, os.read());
+	os.read(value);
+	ASSERT_EQ(0x0708, value);
+	os.read(value);
+	ASSERT_EQ(0x0A0B, value);
+}
+
+TEST_F(uModbusCoilTest, overlappingRegisters) {
+	ArrayStream is({ input, 50 });
+	ArrayStream os({ output, 50 });
+
+	// {0, 0, 2} spans as many addresses as it has entries, but it is not dense.
+	registers[0] = { 0, UMODBUS_TYPE_HOLDING_REGISTER, register_value_buf };
+	registers[1] = { 2, UMODBUS_TYPE_HOLDING_REGISTER, register_value_buf + 1 };
+	registers[2] = { 0, UMODBUS_TYPE_HOLDING_REGISTER, register_value_buf + 2 };
+	ASSERT_FALSE(this->envelop.enveloped_set_registers(registers, 3));
+	ASSERT_EQ(SIZE_MAX, this->envelop.enveloped_find_register(UMODBUS_TABLE_HOLDING_REGISTER, 0));
+
+	is.write((uint8_t)UMODBUS_FNCODE_RD_M_HOLDING_REG);
+	is.write((uint16_t)1);
+	is.write((uint16_t)2);
+
+	ASSERT_EQ(2, this->envelop.enveloped_process(5));
+	ASSERT_EQ(UMODBUS_FNCODE_RD_M_HOLDING_REG + 0x80, os.read());
+	ASSERT_EQ(0x02, os.read());
+
+	// a block running into the next one.
+	registers[0] = { 0, UMODBUS_TYPE_HOLDING_REGISTER, register_value_buf, 4 };
+	registers[1] = { 3, UMODBUS_TYPE_HOLDING_REGISTER, register_value_buf + 4 };
+	ASSERT_FALSE(this->envelop.enveloped_set_registers(registers, 2));
+
+	registers[1] = { 4, UMODBUS_TYPE_HOLDING_REGISTER, register_value_buf + 4 };
+	ASSERT_TRUE(this->envelop.enveloped_set_registers(registers, 2));
+	ASSERT_EQ(1, this->envelop.enveloped_find_register(UMODBUS_TABLE_HOLDING_REGISTER, 4));
+}
+
+typedef struct {
+	size_t reads;
+	size_t writes;
+	uint16_t address;
+	uint16_t count;
+	uint16_t stored[10];
+	bool fail;
+} computed_t;
+
+// register k of the block reads as 0x1000 + k.
+static bool read_computed(void * context, const uint16_t & address, uint8_t * dst, const uint16_t & count) {
+	computed_t * c = (computed_t *)context;
+
+	c->reads++;
+	c->address = address;
+	c->count = count;
+
+	for(uint16_t i = 0; i < count; i++) {
+		umodbus::umodbus_store_u16(dst + i * 2, 0x1000 + address - 100 + i);
+	}
+
+	return !c->fail;
+}
+
+static bool write_computed(void * context, const uint16_t & address, const uint8_t * src, const uint16_t & count) {
+	computed_t * c = (computed_t *)context;
+
+	c->writes++;
+	c->address = address;
+	c->count = count;
+
+	for(uint16_t i = 0; i < count; i++) {
+		c->stored[address - 100 + i] = umodbus::umodbus_load_u16(src + i * 2);
+	}
+
+	return !c->fail;
+}
+
+TEST_F(uModbusCoilTest, readCallbackRange) {
+	ArrayStream is({ input, 50 });
+	ArrayStream os({ output, 50 });
+	computed_t computed = { 0 };
+	umodbus::umodbus_callbacks_t callbacks = { read_computed, write_computed, &computed };
+	uint16_t value;
+
+	registers[0] = { 100, UMODBUS_TYPE_HOLDING_REGISTER_CALLBACK, UMODBUS_CALLBACKS_PTROF(callbacks), 10 };
+	registers[1] = { 110, UMODBUS_TYPE_HOLDING_REGISTER, register_value_buf };
+	register_value_buf[0] = 0xBEEF;
+	this->envelop.enveloped_set_registers(registers, 2);
+	is.write((uint8_t)UMODBUS_FNCODE_RD_M_HOLDING_REG);
+	is.write((uint16_t)107);
+	is.write((uint16_t)4);
+
+	ASSERT_EQ(10, this->envelop.enveloped_process(5));
+
+	// one call for the part of the block the request covers.
+	ASSERT_EQ(1, computed.reads);
+	ASSERT_EQ(107, computed.address);
+	ASSERT_EQ(3, computed.count);
+
+	ASSERT_EQ(UMODBUS_FNCODE_RD_M_HOLDING_REG, os.read());
+	ASSERT_EQ(8, os.read());
+	os.read(value);
+	ASSERT_EQ(0x1007, value);
+	os.read(value);
+	ASSERT_EQ(0x1008, value);
+	os.read(value);
+	ASSERT_EQ(0x1009, value);
+	os.read(value);
+	ASSERT_EQ(0xBEEF, value);
+
+	computed.fail = true;
+	ASSERT_EQ(2, this->envelop.enveloped_process(5));
+	ASSERT_EQ(UMODBUS_FNCODE_RD_M_HOLDING_REG + 0x80, output[0]);
+	ASSERT_EQ(0x04, output[1]);
+}
+
+TEST_F(uModbusCoilTest, writeCallbackRange) {
+	ArrayStream is({ input, 50 });
+	computed_t computed = { 0 };
+	umodbus::umodbus_callbacks_t callbacks = { read_computed, write_computed, &computed };
+
+	registers[0] = { 100, UMODBUS_TYPE_HOLDING_REGISTER_CALLBACK, UMODBUS_CALLBACKS_PTROF(callbacks), 10 };
+	this->envelop.enveloped_set_registers(registers, 1);
+	is.write((uint8_t)UMODBUS_FNCODE_WR_M_HOLDING_REGS);
+	is.write((uint16_t)102);
+	is.write((uint16_t)3);
+	is.write((uint8_t)6);
+	is.write((uint16_t)0x0A0A);
+	is.write((uint16_t)0x0B0B);
+	is.write((uint16_t)0x0C0C);
+
+	ASSERT_EQ(5, this->envelop.enveloped_process(12));
+	ASSERT_EQ(UMODBUS_FNCODE_WR_M_HOLDING_REGS, output[0]);
+	ASSERT_EQ(1, computed.writes);
+	ASSERT_EQ(102, computed.address);
+	ASSERT_EQ(3, computed.count);
+	ASSERT_EQ(0x0A0A, computed.stored[2]);
+	ASSERT_EQ(0x0C0C, computed.stored[4]);
+
+	// without a write callback the block is read only.
+	callbacks.write = 0;
+	ASSERT_EQ(2, this->envelop.enveloped_process(12));
+	ASSERT_EQ(UMODBUS_FNCODE_WR_M_HOLDING_REGS + 0x80, output[0]);
+	ASSERT_EQ(0x02, output[1]);
+	ASSERT_EQ(1, computed.writes);
+}
+
+static std::vector<umodbus::write_range_t> written;
+
+static void record_writes(void * context, const umodbus::write_range_t * ranges, const size_t & count) {
+	(*(size_t *)context)++;
+	written.assign(ranges, ranges + count);
+}
+
+static const umodbus::device_object_t device_objects[] = {
+	{ UMODBUS_OBJECT_PRODUCT_NAME, "Sensor" },
+	{ 0x80, "0123456789012345678901234567890123456789" },
+	{ UMODBUS_OBJECT_VENDOR_NAME, "uModbus" },
+	{ UMODBUS_OBJECT_PRODUCT_CODE, "UM-1" },
+	{ UMODBUS_OBJECT_REVISION, "1.4.0-rc", 5 }
+};
+
+TEST_F(uModbusCoilTest, deviceIdentificationSetup) {
+	uint8_t blob[72];
+
+	ASSERT_FALSE(this->envelop.enveloped_set_device_identification(device_objects, 5, blob, 71));
+	ASSERT_TRUE(this->envelop.enveloped_set_device_identification(device_objects, 5, blob, 72));
+
+	uint8_t expected[] = { 0x00, 7, 'u', 'M', 'o', 'd', 'b', 'u', 's', 0x01, 4, 'U', 'M', '-', '1', 0x02, 5, '1', '.', '4', '.', '0' };
+	ASSERT_EQ(0, memcmp(expected, blob, sizeof(expected)));
+	ASSERT_EQ(UMODBUS_OBJECT_PRODUCT_NAME, blob[22]);
+	ASSERT_EQ(0x80, blob[30]);
+
+	umodbus::device_object_t repeated[] = { device_objects[2], device_objects[3], device_objects[4], device_objects[3] };
+	ASSERT_FALSE(this->envelop.enveloped_set_device_identification(repeated, 4, blob, 72));
+
+	umodbus::device_object_t no_vendor[] = { device_objects[0], device_objects[3], device_objects[4] };
+	ASSERT_FALSE(this->envelop.enveloped_set_device_identification(no_vendor, 3, blob, 72));
+
+	umodbus::device_object_t empty[] = { { UMODBUS_OBJECT_VENDOR_NAME, 0 }, device_objects[3], device_objects[4] };
+	ASSERT_TRUE(this->envelop.enveloped_set_device_identification(empty, 3, blob, 72));
+	ASSERT_EQ(0, blob[1]);
+	empty[0].length = 4;
+	ASSERT_FALSE(this->envelop.enveloped_set_device_identification(empty, 3, blob, 72));
+}
+
+TEST_F(uModbusCoilTest, readDeviceIdentificationBasic) {
+	ArrayStream is({ input, 50 });
+	ArrayStream os({ output, 50 });
+	uint8_t blob[72];
+
+	ASSERT_TRUE(this->envelop.enveloped_set_device_identification(device_objects, 5, blob, 72));
+	is.write((uint8_t)UMODBUS_FNCODE_RD_DEV_ID);
+	is.write((uint8_t)UMODBUS_MEI_RD_DEV_ID);
+	is.write((uint8_t)UMODBUS_DEV_ID_BASIC);
+	is.write((uint8_t)0x00);
+
+	ASSERT_EQ(29, this->envelop.enveloped_process(4));
+
+	uint8_t expected[] = { UMODBUS_FNCODE_RD_DEV_ID, UMODBUS_MEI_RD_DEV_ID, UMODBUS_DEV_ID_BASIC, 0x83, 0x00, 0x00, 3 };
+	ASSERT_EQ(0, memcmp(expected, output, sizeof(expected)));
+	ASSERT_EQ(0, memcmp(blob, output + 7, 22));
+}
+
+TEST_F(uModbusCoilTest, readDeviceIdentificationMoreFollows) {
+	ArrayStream is({ input, 50 });
+	uint8_t blob[72];
+
+	ASSERT_TRUE(this->envelop.enveloped_set_device_identification(device_objects, 5, blob, 72));
+	is.write((uint8_t)UMODBUS_FNCODE_RD_DEV_ID);
+	is.write((uint8_t)UMODBUS_MEI_RD_DEV_ID);
+	is.write((uint8_t)UMODBUS_DEV_ID_EXTENDED);
+	is.write((uint8_t)0x00);
+
+	// 50 byte responses hold objects 0x00-0x04, 0x80 is left for the next request.
+	ASSERT_EQ(37, this->envelop.enveloped_process(4));
+	ASSERT_EQ(0xFF, output[4]);
+	ASSERT_EQ(0x80, output[5]);
+	ASSERT_EQ(4, output[6]);
+	ASSERT_EQ(0, memcmp(blob, output + 7, 30));
+
+	input[3] = 0x80;
+	ASSERT_EQ(49, this->envelop.enveloped_process(4));
+	ASSERT_EQ(0x00, output[4]);
+	ASSERT_EQ(0x00, output[5]);
+	ASSERT_EQ(1, output[6]);
+	ASSERT_EQ(0, memcmp(blob + 30, output + 7, 42));
+
+	// regular access stops before the extended objects, unknown ids restart at 0.
+	input[2] = UMODBUS_DEV_ID_REGULAR;
+	input[3] = 0x03;
+	ASSERT_EQ(37, this->envelop.enveloped_process(4));
+	ASSERT_EQ(0x00, output[4]);
+	ASSERT_EQ(4, output[6]);
+	ASSERT_EQ(0x00, output[7]);
+}
+
+TEST_F(uModbusCoilTest, readDeviceIdentificationIndividual) {
+	ArrayStream is({ input, 50 });
+	ArrayStream os({ output, 50 });
+	uint8_t blob[72];
+
+	ASSERT_TRUE(this->envelop.enveloped_set_device_identification(device_objects, 5, blob, 72));
+	is.write((uint8_t)UMODBUS_FNCODE_RD_DEV_ID);
+	is.write((uint8_t)UMODBUS_MEI_RD_DEV_ID);
+	is.write((uint8_t)UMODBUS_DEV_ID_SPECIFIC);
+	is.write((uint8_t)UMODBUS_OBJECT_PRODUCT_NAME);
+
+	ASSERT_EQ(15, this->envelop.enveloped_process(4));
+
+	uint8_t expected[] = { UMODBUS_FNCODE_RD_DEV_ID, UMODBUS_MEI_RD_DEV_ID, UMODBUS_DEV_ID_SPECIFIC, 0x83, 0x00, 0x00, 1, 
+		UMODBUS_OBJECT_PRODUCT_NAME, 6, 'S', 'e', 'n', 's', 'o', 'r' };
+	ASSERT_EQ(0, memcmp(expected, output, sizeof(expected)));
+
+	input[3] = UMODBUS_OBJECT_VENDOR_URL;
+	ASSERT_EQ(2, this->envelop.enveloped_process(4));
+	ASSERT_EQ(UMODBUS_FNCODE_RD_DEV_ID + 0x80, output[0]);
+	ASSERT_EQ(0x02, output[1]);
+}
+
+TEST_F(uModbusCoilTest, readDeviceIdentificationInvalid) {
+	ArrayStream is({ input, 50 });
+	uint8_t blob[72];
+
+	is.write((uint8_t)UMODBUS_FNCODE_RD_DEV_ID);
+	is.write((uint8_t)UMODBUS_MEI_RD_DEV_ID);
+	is.write((uint8_t)UMODBUS_DEV_ID_BASIC);
+	is.write((uint8_t)0x00);
+
+	// without objects the function is not supported.
+	ASSERT_EQ(2, this->envelop.enveloped_process(4));
+	ASSERT_EQ(UMODBUS_FNCODE_RD_DEV_ID + 0x80, output[0]);
+	ASSERT_EQ(0x01, output[1]);
+
+	ASSERT_TRUE(this->envelop.enveloped_set_device_identification(device_objects, 5, blob, 72));
+	input[2] = 0x05;
+	ASSERT_EQ(2, this->envelop.enveloped_process(4));
+	ASSERT_EQ(0x03, output[1]);
+
+	input[2] = UMODBUS_DEV_ID_BASIC;
+	ASSERT_EQ(2, this->envelop.enveloped_process(3));
+	ASSERT_EQ(0x03, output[1]);
+
+	input[1] = 0x0D;
+	ASSERT_EQ(2, this->envelop.enveloped_process(4));
+	ASSERT_EQ(0x01, output[1]);
+}
+
+TEST_F(uModbusCoilTest, notifyWrittenRange) {
+	ArrayStream is({ input, 50 });
+	ArrayStream os({ output, 50 });
+	size_t calls = 0;
+
+	this->configure_registers(UMODBUS_TYPE_HOLDING_REGISTER);
+	this->envelop.enveloped_set_write_callback(record_writes, &calls);
+	is.write((uint8_t)UMODBUS_FNCODE_WR_M_HOLDING_REGS);
+	is.write((uint16_t)3);
+	is.write((uint16_t)2);
+	is.write((uint8_t)4);
+	is.write((uint16_t)0x0102);
+	is.write((uint16_t)0x0304);
+
+	ASSERT_EQ(5, this->envelop.enveloped_process(10));
+	ASSERT_EQ(1, calls);
+	ASSERT_EQ(1, written.size());
+	ASSERT_EQ(UMODBUS_TABLE_HOLDING_REGISTER, written[0].table);
+	ASSERT_EQ(3, written[0].address);
+	ASSERT_EQ(2, written[0].count);
+
+	// reads change nothing and stay silent.
+	is.wseek(0);
+	is.write((uint8_t)UMODBUS_FNCODE_RD_M_HOLDING_REG);
+	is.write((uint16_t)0);
+	is.write((uint16_t)2);
+
+	ASSERT_EQ(6, this->envelop.enveloped_process(5));
+	ASSERT_EQ(1, calls);
+}
+
+TEST_F(uModbusCoilTest, writeReadOnlyStorage) {
+	ArrayStream is({ input, 50 });
+	size_t calls = 0;
+	umodbus::umodbus_fifo_t fifo;
+	umodbus::umodbus_bank_t bank;
+	uint16_t storage[8];
+	umodbus::umodbus_callbacks_t callbacks = { read_computed, 0, 0 };
+	// FC06 to the fifo, FC16 into the bank, FC22 and FC23 on the callback block, FC16 across it.
+	uint8_t requests[][12] = {
+		{ UMODBUS_FNCODE_WR_S_HOLDING_REG, 0x00, 0x00, 0x12, 0x34 },
+		{ UMODBUS_FNCODE_WR_M_HOLDING_REGS, 0x00, 0x02, 0x00, 0x02, 4, 0x01, 0x02, 0x03, 0x04 },
+		{ UMODBUS_FNCODE_MSK_WR_REG, 0x00, 0x05, 0x00, 0xF2, 0x00, 0x25 },
+		{ UMODBUS_FNCODE_RW_M_REG, 0x00, 0x07, 0x00, 0x01, 0x00, 0x06, 0x00, 0x01, 2, 0x01, 0x02 },
+		{ UMODBUS_FNCODE_WR_M_HOLDING_REGS, 0x00, 0x06, 0x00, 0x02, 4, 0x01, 0x02, 0x03, 0x04 },
+	};
+	size_t lengths[] = { 5, 10, 7, 12, 10 };
+
+	umodbus::umodbus_fifo_init(&fifo);
+	umodbus::umodbus_bank_init(&bank, storage, 4);
+	registers[0] = { 0, UMODBUS_TYPE_HOLDING_REGISTER_FIFO, UMODBUS_FIFO_PTROF(fifo), 1 };
+	registers[1] = { 1, UMODBUS_TYPE_HOLDING_REGISTER_BANK, UMODBUS_BANK_PTROF(bank), 4 };
+	registers[2] = { 5, UMODBUS_TYPE_HOLDING_REGISTER_CALLBACK, UMODBUS_CALLBACKS_PTROF(callbacks), 2 };
+	registers[3] = { 7, UMODBUS_TYPE_HOLDING_REGISTER, register_value_buf };
+	register_value_buf[0] = 0x0042;
+	this->envelop.enveloped_set_registers(registers, 4);
+	this->envelop.enveloped_set_write_callback(record_writes, &calls);
+
+	for(size_t i = 0; i < 5; i++) {
+		is.wseek(0);
+		is.write(requests[i], lengths[i]);
+
+		ASSERT_EQ(2, this->envelop.enveloped_process(lengths[i]));
+		ASSERT_EQ(requests[i][0] + 0x80, output[0]);
+		ASSERT_EQ(0x02, output[1]);
+	}
+
+	ASSERT_EQ(0, calls);
+	ASSERT_EQ(0, umodbus::umodbus_fifo_count(&fifo));
+	ASSERT_EQ(0x0042, register_value_buf[0]);
+}
+
+TEST_F(uModbusCoilTest, notifyStoredSegmentsOnly) {
+	ArrayStream is({ input, 50 });
+	size_t calls = 0;
+	computed_t computed = { 0 };
+	umodbus::umodbus_callbacks_t callbacks = { read_computed, write_computed, &computed };
+
+	registers[0] = { 98, UMODBUS_TYPE_HOLDING_REGISTER, register_value_buf, 2 };
+	registers[1] = { 100, UMODBUS_TYPE_HOLDING_REGISTER_CALLBACK, UMODBUS_CALLBACKS_PTROF(callbacks), 10 };
+	this->envelop.enveloped_set_registers(registers, 2);
+	this->envelop.enveloped_set_write_callback(record_writes, &calls);
+	computed.fail = true;
+	is.write((uint8_t)UMODBUS_FNCODE_WR_M_HOLDING_REGS);
+	is.write((uint16_t)99);
+	is.write((uint16_t)3);
+	is.write((uint8_t)6);
+	is.write((uint16_t)0x0A0A);
+	is.write((uint16_t)0x0B0B);
+	is.write((uint16_t)0x0C0C);
+
+	ASSERT_EQ(2, this->envelop.enveloped_process(12));
+	ASSERT_EQ(0x04, output[1]);
+
+	// 99 was stored, the callback refused 100-101.
+	ASSERT_EQ(1, calls);
+	ASSERT_EQ(1, written.size());
+	ASSERT_EQ(99, written[0].address);
+	ASSERT_EQ(1, written[0].count);
+}
+
+#ifdef UMODBUS_STATS
+TEST_F(uModbusCoilTest, countRequests) {
+	ArrayStream is({ input, 50 });
+	ArrayStream os({ output, 50 });
+	const umodbus::umodbus_stats_t * stats = this->envelop.enveloped_get_stats();
+	uint32_t handled = 0;
+
+	this->configure_registers(UMODBUS_TYPE_HOLDING_REGISTER);
+	is.write((uint8_t)UMODBUS_FNCODE_RD_M_HOLDING_REG);
+	is.write((uint16_t)0);
+	is.write((uint16_t)2);
+	is.write((uint8_t)UMODBUS_FNCODE_RD_M_HOLDING_REG);
+	is.write((uint16_t)9);
+	is.write((uint16_t)2);
+
+	ASSERT_EQ(6, this->envelop.enveloped_process(5));
+	memmove(input, input + 5, 5);
+	ASSERT_EQ(2, this->envelop.enveloped_process(5));
+
+	ASSERT_EQ(2, stats->requests[UMODBUS_FNCODE_RD_M_HOLDING_REG]);
+	ASSERT_EQ(1, stats->exceptions[UMODBUS_FNCODE_RD_M_HOLDING_REG]);
+	ASSERT_EQ(10, stats->bytes_in);
+	ASSERT_EQ(8, stats->bytes_out);
+	ASSERT_EQ(1, stats->events);
+
+	for(size_t i = 0; i < UMODBUS_STATS_BUCKETS; i++) {
+		handled += stats->handler_time[i];
+	}
+	ASSERT_EQ(2, handled);
+
+	ASSERT_EQ(0, umodbus::umodbus_stats_bucket(0));
+	ASSERT_EQ(1, umodbus::umodbus_stats_bucket(1));
+	ASSERT_EQ(4, umodbus::umodbus_stats_bucket(15));
+	ASSERT_EQ(5, umodbus::umodbus_stats_bucket(16));
+	ASSERT_EQ(UMODBUS_STATS_BUCKETS - 1, umodbus::umodbus_stats_bucket(0xFFFFFFFF));
+}
+
+TEST_F(uModbusCoilTest, commEventCounterAndLog) {
+	ArrayStream is({ input, 50 });
+	ArrayStream os({ output, 50 });
+	uint16_t value;
+
+	this->configure_registers(UMODBUS_TYPE_HOLDING_REGISTER);
+	is.write((uint8_t)UMODBUS_FNCODE_WR_S_HOLDING_REG);
+	is.write((uint16_t)1);
+	is.write((uint16_t)0x1234);
+	ASSERT_EQ(5, this->envelop.enveloped_process(5));
+
+	is.wseek(0);
+	is.write((uint8_t)UMODBUS_FNCODE_WR_S_HOLDING_REG);
+	is.write((uint16_t)20);
+	is.write((uint16_t)0x1234);
+	ASSERT_EQ(2, this->envelop.enveloped_process(5));
+
+	input[0] = UMODBUS_FNCODE_GET_COMM_EV_CNTR;
+	ASSERT_EQ(5, this->envelop.enveloped_process(1));
+	ASSERT_EQ(UMODBUS_FNCODE_GET_COMM_EV_CNTR, os.read());
+	os.read(value);
+	ASSERT_EQ(0, value);
+	os.read(value);
+	ASSERT_EQ(1, value);
+
+	os.rseek(0);
+	input[0] = UMODBUS_FNCODE_GET_COMM_EV_LOG;
+	ASSERT_EQ(11, this->envelop.enveloped_process(1));
+	ASSERT_EQ(UMODBUS_FNCODE_GET_COMM_EV_LOG, os.read());
+	ASSERT_EQ(9, os.read());
+	os.read(value);
+	ASSERT_EQ(0, value);
+	os.read(value);
+	ASSERT_EQ(1, value);
+	os.read(value);
+	ASSERT_EQ(3, value);
+	ASSERT_EQ(0x40, os.read());
+	ASSERT_EQ(0x41, os.read());
+	ASSERT_EQ(0x40, os.read());
+}
+
+TEST_F(uModbusCoilTest, diagnosticsEcho) {
+	ArrayStream is({ input, 50 });
+	ArrayStream os({ output, 50 });
+	const uint8_t request[] = { UMODBUS_FNCODE_DIAGNOSTICS, 0x00, 0x00, 0xA5, 0x37 };
+
+	this->configure_registers(UMODBUS_TYPE_HOLDING_REGISTER);
+	memcpy(input, request, sizeof(request));
+
+	ASSERT_EQ(5, this->envelop.enveloped_process(5));
+	ASSERT_EQ(0, memcmp(request, output, sizeof(request)));
+
+	input[2] = 0x03;
+	ASSERT_EQ(2, this->envelop.enveloped_process(5));
+	ASSERT_EQ(UMODBUS_FNCODE_DIAGNOSTICS + 0x80, output[0]);
+	ASSERT_EQ(0x01, output[1]);
+}
+#endif